@@ -9,4 +9,10 @@ namespace nn::fs {
         mount: drive to mount to.
     */
     Result MountSdCardForDebug(char const* mount);
+
+    /*
+        Unmount a previously mounted drive.
+        mount: drive to unmount.
+    */
+    void Unmount(char const* mount);
 };
\ No newline at end of file
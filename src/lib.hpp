@@ -7,19 +7,28 @@
 #include "lib/diag/abort.hpp"
 #include "lib/diag/assert.hpp"
 
+#include "lib/heap/heap.hpp"
+
+#include "lib/reloc/relocate.hpp"
 #include "lib/reloc/rtld.hpp"
 
 #include "lib/patch/code_patcher.hpp"
 #include "lib/patch/patcher_impl.hpp"
+#include "lib/patch/patch_set.hpp"
+#include "lib/patch/patch_table.hpp"
 #include "lib/patch/random_access_patcher.hpp"
 #include "lib/patch/stream_patcher.hpp"
 
 #include "lib/util/math/bitset.hpp"
+#include "lib/util/hash.hpp"
+#include "lib/util/spin_lock.hpp"
+#include "lib/util/sys/build_id.hpp"
 #include "lib/util/sys/cur_proc_handle.hpp"
 #include "lib/util/sys/jit.hpp"
 #include "lib/util/sys/mem_layout.hpp"
 #include "lib/util/sys/rw_pages.hpp"
 #include "lib/util/sys/soc.hpp"
+#include "lib/util/sys/symbol_cache.hpp"
 #include "lib/util/modules.hpp"
 #include "lib/util/ptr_path.hpp"
 #include "lib/util/typed_storage.hpp"
@@ -28,5 +37,7 @@
 #include "lib/hook/class.hpp"
 #include "lib/hook/deprecated.hpp"
 #include "lib/hook/inline.hpp"
+#include "lib/hook/profile.hpp"
+#include "lib/hook/profiled_trampoline.hpp"
 #include "lib/hook/replace.hpp"
 #include "lib/hook/trampoline.hpp"
@@ -14,4 +14,5 @@ namespace exl::armv8 {
     using InstBitSet = util::BitSet<InstType>;
 }
 
-#include "armv8/instructions.hpp"
\ No newline at end of file
+#include "armv8/instructions.hpp"
+#include "armv8/decoder.hpp"
\ No newline at end of file
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "../armv8.hpp"
+
+#include <array>
+
+namespace exl::armv8 {
+
+    /* Matches instructions whose bits under m_Mask equal m_Value. */
+    struct InstPattern {
+        InstType m_Value;
+        InstType m_Mask;
+
+        constexpr InstPattern() : m_Value(), m_Mask() {}
+        constexpr InstPattern(InstType value, InstType mask = ~InstType()) : m_Value(value & mask), m_Mask(mask) {}
+        constexpr InstPattern(InstBitSet inst, InstType mask = ~InstType()) : InstPattern(inst.Value(), mask) {}
+
+        constexpr bool Matches(InstType inst) const {
+            return (inst & m_Mask) == m_Value;
+        }
+    };
+}
+
+namespace exl::armv8::decode {
+
+    enum class InstKind : u8 {
+        Unknown,
+        B,
+        BL,
+        BCond,
+        Cbz,
+        Cbnz,
+        Tbz,
+        Tbnz,
+        Br,
+        Blr,
+        Ret,
+        Nop,
+        Adr,
+        Adrp,
+        AddImmediate,
+        SubImmediate,
+        Movn,
+        Movz,
+        Movk,
+        LdrLiteral,
+        LdrImmediate,
+        StrImmediate,
+    };
+
+    struct DecodedInst {
+        InstKind m_Kind;
+        /* Destination, or the register that is tested, loaded or stored. */
+        u8 m_Rd;
+        u8 m_Rn;
+        bool m_Is64;
+        inst::Condition m_Cond;
+        /* Bit tested by TBZ/TBNZ. */
+        u8 m_Bit;
+        /* Branch and literal offsets are in bytes from the instruction, ADRP's from its page. Load/store offsets are in
+           bytes, unlike the scaled index the encoders take. Otherwise this is the immediate operand after shifting. */
+        s64 m_Imm;
+    };
+
+    namespace impl {
+        struct KindPattern {
+            InstKind m_Kind;
+            InstPattern m_Pattern;
+        };
+
+        /* Patterns are the encoders' output with every operand masked out. */
+        constexpr std::array KindPatterns {
+            KindPattern { InstKind::B,              InstPattern(inst::Branch(0),                                0xFC000000) },
+            KindPattern { InstKind::BL,             InstPattern(inst::BranchLink(0),                            0xFC000000) },
+            KindPattern { InstKind::BCond,          InstPattern(inst::BranchCond(inst::Condition_EQ, 0),        0xFF000010) },
+            KindPattern { InstKind::Cbz,            InstPattern(inst::Cbz(reg::W0, 0),                          0x7F000000) },
+            KindPattern { InstKind::Cbnz,           InstPattern(inst::Cbnz(reg::W0, 0),                         0x7F000000) },
+            KindPattern { InstKind::Tbz,            InstPattern(inst::Tbz(reg::W0, 0, 0),                       0x7F000000) },
+            KindPattern { InstKind::Tbnz,           InstPattern(inst::Tbnz(reg::W0, 0, 0),                      0x7F000000) },
+            KindPattern { InstKind::Br,             InstPattern(inst::BranchRegister(reg::X0),                  0xFFFFFC1F) },
+            KindPattern { InstKind::Blr,            InstPattern(inst::BranchLinkRegister(reg::X0),              0xFFFFFC1F) },
+            KindPattern { InstKind::Ret,            InstPattern(inst::Ret(reg::X0),                             0xFFFFFC1F) },
+            KindPattern { InstKind::Nop,            InstPattern(inst::Nop()) },
+            KindPattern { InstKind::Adr,            InstPattern(inst::Adr(reg::X0, 0),                          0x9F000000) },
+            KindPattern { InstKind::Adrp,           InstPattern(inst::Adrp(reg::X0, 0),                         0x9F000000) },
+            KindPattern { InstKind::AddImmediate,   InstPattern(inst::AddImmediate(reg::W0, reg::W0, 0),        0x7F800000) },
+            KindPattern { InstKind::SubImmediate,   InstPattern(inst::SubImmediate(reg::W0, reg::W0, 0),        0x7F800000) },
+            KindPattern { InstKind::Movn,           InstPattern(inst::Movn(reg::W0, 0),                         0x7F800000) },
+            KindPattern { InstKind::Movz,           InstPattern(inst::Movz(reg::W0, 0),                         0x7F800000) },
+            KindPattern { InstKind::Movk,           InstPattern(inst::Movk(reg::W0, 0),                         0x7F800000) },
+            /* General purpose registers only. */
+            KindPattern { InstKind::LdrLiteral,     InstPattern(inst::LdrLiteral(reg::W0, 0),                   0xBF000000) },
+            KindPattern { InstKind::LdrImmediate,   InstPattern(inst::LdrRegisterImmediate(reg::W0, reg::X0),   0xBFC00000) },
+            KindPattern { InstKind::StrImmediate,   InstPattern(inst::StrRegisterImmediate(reg::W0, reg::X0),   0xBFC00000) },
+        };
+
+        template<InstType Low, InstType High>
+        constexpr InstType Field(InstType value) {
+            constexpr auto Mask = InstMask<Low, High>();
+            return InstBitSet(value).BitsOf<Mask>();
+        }
+
+        constexpr s64 SignExtend(InstType value, size_t bits) {
+            return static_cast<s64>(static_cast<u64>(value) << (64 - bits)) >> (64 - bits);
+        }
+    }
+
+    /* Matches any instruction of a kind. */
+    constexpr InstPattern PatternOf(InstKind kind) {
+        for(const auto& entry : impl::KindPatterns) {
+            if(entry.m_Kind == kind)
+                return entry.m_Pattern;
+        }
+        /* Unknown matches nothing. */
+        return InstPattern(~InstType(), 0);
+    }
+
+    constexpr InstKind GetKind(InstType inst) {
+        for(const auto& entry : impl::KindPatterns) {
+            if(entry.m_Pattern.Matches(inst))
+                return entry.m_Kind;
+        }
+        return InstKind::Unknown;
+    }
+
+    constexpr DecodedInst Decode(InstType value) {
+        DecodedInst out {
+            .m_Kind = GetKind(value),
+            .m_Rd = static_cast<u8>(impl::Field<0, 5>(value)),
+            .m_Rn = static_cast<u8>(impl::Field<5, 10>(value)),
+            .m_Is64 = impl::Field<31, 32>(value) != 0,
+            .m_Cond = inst::Condition_AL,
+            .m_Bit = 0,
+            .m_Imm = 0,
+        };
+
+        switch(out.m_Kind) {
+            case InstKind::B:
+            case InstKind::BL:
+                out.m_Is64 = true;
+                out.m_Imm = impl::SignExtend(impl::Field<0, 26>(value), 26) * 4;
+                break;
+            case InstKind::BCond:
+                out.m_Cond = static_cast<inst::Condition>(impl::Field<0, 4>(value));
+                out.m_Imm = impl::SignExtend(impl::Field<5, 24>(value), 19) * 4;
+                break;
+            case InstKind::Cbz:
+            case InstKind::Cbnz:
+                out.m_Imm = impl::SignExtend(impl::Field<5, 24>(value), 19) * 4;
+                break;
+            case InstKind::Tbz:
+            case InstKind::Tbnz:
+                out.m_Bit = (impl::Field<31, 32>(value) << 5) | impl::Field<19, 24>(value);
+                out.m_Imm = impl::SignExtend(impl::Field<5, 19>(value), 14) * 4;
+                break;
+            case InstKind::Br:
+            case InstKind::Blr:
+            case InstKind::Ret:
+                out.m_Rd = out.m_Rn;
+                out.m_Is64 = true;
+                break;
+            case InstKind::Adr:
+            case InstKind::Adrp: {
+                const s64 imm = impl::SignExtend((impl::Field<5, 24>(value) << 2) | impl::Field<29, 31>(value), 21);
+                out.m_Is64 = true;
+                out.m_Imm = out.m_Kind == InstKind::Adrp ? imm << 12 : imm;
+                break;
+            }
+            case InstKind::AddImmediate:
+            case InstKind::SubImmediate:
+                out.m_Imm = static_cast<s64>(impl::Field<10, 22>(value)) << (impl::Field<22, 23>(value) ? 12 : 0);
+                break;
+            case InstKind::Movn:
+            case InstKind::Movz:
+            case InstKind::Movk:
+                out.m_Imm = static_cast<s64>(impl::Field<5, 21>(value)) << (impl::Field<21, 23>(value) * 16);
+                break;
+            case InstKind::LdrLiteral:
+                out.m_Is64 = impl::Field<30, 31>(value) != 0;
+                out.m_Imm = impl::SignExtend(impl::Field<5, 24>(value), 19) * 4;
+                break;
+            case InstKind::LdrImmediate:
+            case InstKind::StrImmediate:
+                out.m_Is64 = impl::Field<30, 31>(value) != 0;
+                out.m_Imm = static_cast<s64>(impl::Field<10, 22>(value)) << impl::Field<30, 32>(value);
+                break;
+            default:
+                break;
+        }
+
+        return out;
+    }
+
+    static_assert(Decode(inst::Branch(-0x4).Value()).m_Kind                             == InstKind::B, "");
+    static_assert(Decode(inst::Branch(-0x4).Value()).m_Imm                              == -0x4, "");
+    static_assert(Decode(inst::BranchLink(0x6900).Value()).m_Imm                        == 0x6900, "");
+    static_assert(Decode(inst::BranchCond(inst::Condition_NE, -0x4).Value()).m_Cond     == inst::Condition_NE, "");
+    static_assert(Decode(inst::Cbnz(reg::X2, 0x40).Value()).m_Is64, "");
+    static_assert(Decode(inst::Tbnz(reg::X1, 33, -0x4).Value()).m_Bit                   == 33, "");
+    static_assert(Decode(inst::Tbnz(reg::X1, 33, -0x4).Value()).m_Imm                   == -0x4, "");
+    static_assert(Decode(inst::BranchLinkRegister(reg::X17).Value()).m_Rd               == 17, "");
+    static_assert(Decode(inst::Ret().Value()).m_Kind                                    == InstKind::Ret, "");
+    static_assert(Decode(inst::Nop().Value()).m_Kind                                    == InstKind::Nop, "");
+    static_assert(Decode(inst::Adr(reg::X2, 0x69669u).Value()).m_Imm                    == 0x69669, "");
+    static_assert(Decode(inst::Adrp(reg::X0, 0x1000u).Value()).m_Imm                    == 0x1000, "");
+    static_assert(Decode(inst::AddImmediate(reg::X0, reg::SP, 0x10).Value()).m_Imm      == 0x10, "");
+    static_assert(Decode(inst::Movz(reg::W0, 1).Value()).m_Kind                         == InstKind::Movz, "");
+    static_assert(Decode(inst::Movk(reg::X3, 0xBEEF).Value()).m_Imm                     == 0xBEEF, "");
+    static_assert(Decode(inst::LdrLiteral(reg::X17, 0x8).Value()).m_Imm                 == 0x8, "");
+    static_assert(Decode(inst::LdrRegisterImmediate(reg::X10, reg::X11, 1).Value()).m_Imm == 0x8, "");
+    static_assert(Decode(inst::StrRegisterImmediate(reg::W16, reg::X17, 20).Value()).m_Imm == 0x50, "");
+    static_assert(Decode(inst::StrRegisterImmediate(reg::W16, reg::X17, 20).Value()).m_Rn  == 17, "");
+    static_assert(Decode(inst::Fadd(reg::S0, reg::S1, reg::S2).Value()).m_Kind          == InstKind::Unknown, "");
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <lib/armv8.hpp>
+#include "lib/diag/assert.hpp"
+#include "lib/result.hpp"
 
 namespace exl::armv8::inst {
 
@@ -32,9 +34,61 @@ namespace exl::armv8::inst {
         ExtendType_SXTX = 0b111, 
     };
 
+    enum Condition : u8 {
+        Condition_EQ = 0b0000,
+        Condition_NE = 0b0001,
+        Condition_CS = 0b0010,
+        Condition_HS = 0b0010,
+        Condition_CC = 0b0011,
+        Condition_LO = 0b0011,
+        Condition_MI = 0b0100,
+        Condition_PL = 0b0101,
+        Condition_VS = 0b0110,
+        Condition_VC = 0b0111,
+        Condition_HI = 0b1000,
+        Condition_LS = 0b1001,
+        Condition_GE = 0b1010,
+        Condition_LT = 0b1011,
+        Condition_GT = 0b1100,
+        Condition_LE = 0b1101,
+        Condition_AL = 0b1110,
+    };
+
+    namespace impl {
+        /* Deliberately not constexpr, reaching this while constant evaluating turns a bad operand into a compile error. */
+        inline void OperandOutOfRange() {
+            EXL_ABORT(result::ArmOperandOutOfRange);
+        }
+
+        /* Scales a signed operand down and truncates it to a field of Bits bits, the operand must be a multiple of
+           Scale and fit in the field once scaled. */
+        template<size_t Bits, s64 Scale = 1>
+        constexpr InstType EncodeSignedOffset(s64 offset) {
+            constexpr s64 Min = -(s64(1) << (Bits - 1));
+            constexpr s64 Max = (s64(1) << (Bits - 1)) - 1;
+
+            if(offset % Scale != 0 || offset / Scale < Min || Max < offset / Scale)
+                OperandOutOfRange();
+
+            return static_cast<InstType>(offset / Scale) & ((InstType(1) << Bits) - 1);
+        }
+
+        /* Same as above for fields that hold an unsigned operand. */
+        template<size_t Bits, u64 Scale = 1>
+        constexpr InstType EncodeUnsignedOffset(u64 offset) {
+            constexpr u64 Max = (u64(1) << Bits) - 1;
+
+            if(offset % Scale != 0 || Max < offset / Scale)
+                OperandOutOfRange();
+
+            return static_cast<InstType>(offset / Scale);
+        }
+    }
+
 }
 
 #include "op100x/base.hpp"
 #include "op101x/base.hpp"
 #include "opx1x0/base.hpp"
-#include "opx101/base.hpp"
\ No newline at end of file
+#include "opx101/base.hpp"
+#include "opx111/base.hpp"
\ No newline at end of file
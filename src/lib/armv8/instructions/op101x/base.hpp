@@ -16,6 +16,9 @@ namespace exl::armv8::inst::impl {
     };
 }
 
+#include "compare_and_branch_immediate/base.hpp"
+#include "conditional_branch_immediate/base.hpp"
 #include "hints/base.hpp"
+#include "test_and_branch_immediate/base.hpp"
 #include "unconditional_branch_immediate/base.hpp"
 #include "unconditional_branch_register/base.hpp"
\ No newline at end of file
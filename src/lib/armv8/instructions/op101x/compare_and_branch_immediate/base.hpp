@@ -0,0 +1,31 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::op101x {
+
+    struct CompareAndBranchImmediate : public Op101xInstruction {
+
+        static constexpr u8 Op0 = 0b001;
+
+        ACCESSOR(Sf,    31);
+        ACCESSOR(Op,    24);
+        ACCESSOR(Imm19, 5, 24);
+        ACCESSOR(Rt,    0, 5);
+
+        enum Op : u8 {
+            CBZ  = 0,
+            CBNZ = 1,
+        };
+
+        constexpr CompareAndBranchImmediate(Op op, reg::Register rt, s64 relative_address) : Op101xInstruction(Op0) {
+            SetSf(rt.Is64());
+            SetOp(op);
+            SetImm19(EncodeSignedOffset<Imm19Mask.Count, 4>(relative_address));
+            SetRt(rt.Index());
+        }
+    };
+}
+
+#include "cbz.hpp"
+#include "cbnz.hpp"
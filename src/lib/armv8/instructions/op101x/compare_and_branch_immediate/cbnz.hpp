@@ -0,0 +1,14 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Cbnz : public impl::op101x::CompareAndBranchImmediate {
+
+        constexpr Cbnz(reg::Register rt, s64 relative_address) : CompareAndBranchImmediate(CBNZ, rt, relative_address) {}
+    };
+
+    static_assert(Cbnz(reg::W1, -0x4).Value()   == 0x35FFFFE1, "");
+    static_assert(Cbnz(reg::X2, 0x40).Value()   == 0xB5000202, "");
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Cbz : public impl::op101x::CompareAndBranchImmediate {
+
+        constexpr Cbz(reg::Register rt, s64 relative_address) : CompareAndBranchImmediate(CBZ, rt, relative_address) {}
+    };
+
+    static_assert(Cbz(reg::X0, 0x8).Value()     == 0xB4000040, "");
+    static_assert(Cbz(reg::W1, -0x4).Value()    == 0x34FFFFE1, "");
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct BranchCond : public impl::op101x::ConditionalBranchImmediate {
+
+        constexpr BranchCond(Condition cond, s64 relative_address) : ConditionalBranchImmediate(cond, relative_address) {}
+    };
+
+    static_assert(BranchCond(Condition_EQ, 0x8).Value()     == 0x54000040, "");
+    static_assert(BranchCond(Condition_NE, -0x4).Value()    == 0x54FFFFE1, "");
+    static_assert(BranchCond(Condition_AL, 0x100).Value()   == 0x5400080E, "");
+}
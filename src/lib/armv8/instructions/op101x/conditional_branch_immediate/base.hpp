@@ -0,0 +1,25 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::op101x {
+
+    struct ConditionalBranchImmediate : public Op101xInstruction {
+
+        static constexpr u8 Op0 = 0b010;
+
+        ACCESSOR(O1,    24);
+        ACCESSOR(Imm19, 5, 24);
+        ACCESSOR(O0,    4);
+        ACCESSOR(Cond,  0, 4);
+
+        constexpr ConditionalBranchImmediate(Condition cond, s64 relative_address) : Op101xInstruction(Op0) {
+            SetO1(0);
+            SetImm19(EncodeSignedOffset<Imm19Mask.Count, 4>(relative_address));
+            SetO0(0);
+            SetCond(cond);
+        }
+    };
+}
+
+#include "b_cond.hpp"
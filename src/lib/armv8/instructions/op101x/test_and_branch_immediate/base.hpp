@@ -0,0 +1,43 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::op101x {
+
+    struct TestAndBranchImmediate : public Op101xInstruction {
+
+        /* Bit 25 is set here, unlike the rest of the branch group. */
+        static constexpr u8 MainOp0 = 0b1011;
+        static constexpr u8 Op0 = 0b001;
+
+        ACCESSOR(B5,    31);
+        ACCESSOR(Op,    24);
+        ACCESSOR(B40,   19, 24);
+        ACCESSOR(Imm14, 5, 19);
+        ACCESSOR(Rt,    0, 5);
+
+        enum Op : u8 {
+            TBZ  = 0,
+            TBNZ = 1,
+        };
+
+        static constexpr InstType EncodeBit(reg::Register rt, u8 bit) {
+            if(bit >= rt.Size() * 8)
+                OperandOutOfRange();
+
+            return bit;
+        }
+
+        constexpr TestAndBranchImmediate(Op op, reg::Register rt, u8 bit, s64 relative_address) : Op101xInstruction(Op0) {
+            SetMainOp0(MainOp0);
+            SetB5(EncodeBit(rt, bit) >> B40Mask.Count);
+            SetOp(op);
+            SetB40(bit);
+            SetImm14(EncodeSignedOffset<Imm14Mask.Count, 4>(relative_address));
+            SetRt(rt.Index());
+        }
+    };
+}
+
+#include "tbz.hpp"
+#include "tbnz.hpp"
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Tbnz : public impl::op101x::TestAndBranchImmediate {
+
+        constexpr Tbnz(reg::Register rt, u8 bit, s64 relative_address) : TestAndBranchImmediate(TBNZ, rt, bit, relative_address) {}
+    };
+
+    static_assert(Tbnz(reg::X1, 33, -0x4).Value()   == 0xB70FFFE1, "");
+    static_assert(Tbnz(reg::W2, 0, 0x10).Value()    == 0x37000082, "");
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Tbz : public impl::op101x::TestAndBranchImmediate {
+
+        constexpr Tbz(reg::Register rt, u8 bit, s64 relative_address) : TestAndBranchImmediate(TBZ, rt, bit, relative_address) {}
+    };
+
+    static_assert(Tbz(reg::W0, 3, 0x8).Value()      == 0x36180040, "");
+    static_assert(Tbz(reg::X5, 63, -0x8000).Value() == 0xB6FC0005, "");
+}
@@ -16,9 +16,9 @@ namespace exl::armv8::inst::impl::op101x {
             BL = 1,
         };
 
-        constexpr UnconditionalBranchImmediate(Op op, uint relative_address) : Op101xInstruction(Op0) {
+        constexpr UnconditionalBranchImmediate(Op op, s64 relative_address) : Op101xInstruction(Op0) {
             SetOp(op);
-            SetImm26(relative_address / 4);
+            SetImm26(EncodeSignedOffset<Imm26Mask.Count, 4>(relative_address));
         }
     };
 }
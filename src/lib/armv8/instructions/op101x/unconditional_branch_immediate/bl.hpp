@@ -6,11 +6,12 @@ namespace exl::armv8::inst {
 
     struct BranchLink : public impl::op101x::UnconditionalBranchImmediate {
 
-        constexpr BranchLink(uint relative_address) : UnconditionalBranchImmediate(UnconditionalBranchImmediate::BL, relative_address) {}
+        constexpr BranchLink(s64 relative_address) : UnconditionalBranchImmediate(UnconditionalBranchImmediate::BL, relative_address) {}
     };
 
     static_assert(BranchLink(0x4440).Value() == 0x94001110, "");
     static_assert(BranchLink(0x4200).Value() == 0x94001080, "");
     static_assert(BranchLink(0x6900).Value() == 0x94001A40, "");
     static_assert(BranchLink(0x0008).Value() == 0x94000002, "");
+    static_assert(BranchLink(-0x0004).Value() == 0x97FFFFFF, "");
 }
\ No newline at end of file
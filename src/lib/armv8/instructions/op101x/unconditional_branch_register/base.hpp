@@ -23,5 +23,6 @@ namespace exl::armv8::inst::impl::op101x {
     };
 }
 
+#include "blr.hpp"
 #include "br.hpp"
 #include "ret.hpp"
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl {
+
+    struct Opx111Instruction : public Instruction {
+
+        ACCESSOR(Op0, 28, 32);
+
+        constexpr Opx111Instruction(u8 op0) : Instruction(0b0111) {
+            SetOp0(op0);
+        }
+    };
+
+    /* Scalar floating point instructions, only single and double precision operands are supported. */
+    struct FloatingPointInstruction : public Opx111Instruction {
+
+        static constexpr u8 Op0 = 0b0001;
+
+        ACCESSOR(Sf,    31);
+        ACCESSOR(Ftype, 22, 24);
+        ACCESSOR(Op2,   21);
+
+        static constexpr u8 GetFtype(reg::Register fp) {
+            switch(fp.Kind()) {
+                case reg::RegisterKind::S:
+                    return 0b00;
+                case reg::RegisterKind::D:
+                    return 0b01;
+                default:
+                    OperandOutOfRange();
+                    return 0b00;
+            }
+        }
+
+        constexpr FloatingPointInstruction(reg::Register fp) : Opx111Instruction(Op0) {
+            SetFtype(GetFtype(fp));
+            SetOp2(1);
+        }
+    };
+}
+
+#include "floating_point_data_processing_1_source/base.hpp"
+#include "floating_point_data_processing_2_source/base.hpp"
+#include "floating_point_integer_conversion/base.hpp"
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::opx111 {
+
+    struct FloatingPointDataProcessing1Source : public FloatingPointInstruction {
+
+        static constexpr u8 Op4 = 0b10000;
+
+        ACCESSOR(Opcode,    15, 21);
+        ACCESSOR(LocalOp4,  10, 15);
+        ACCESSOR(Rn,        5, 10);
+        ACCESSOR(Rd,        0, 5);
+
+        constexpr FloatingPointDataProcessing1Source(u8 opcode, reg::Register rd, reg::Register rn) : FloatingPointInstruction(rd) {
+            if(rd.Kind() != rn.Kind())
+                OperandOutOfRange();
+
+            SetOpcode(opcode);
+            SetLocalOp4(Op4);
+            SetRn(rn.Index());
+            SetRd(rd.Index());
+        }
+    };
+}
+
+#include "fmov_register.hpp"
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct FmovRegister : public impl::opx111::FloatingPointDataProcessing1Source {
+
+        static constexpr u8 Opcode = 0b000000;
+
+        constexpr FmovRegister(reg::Register rd, reg::Register rn) : FloatingPointDataProcessing1Source(Opcode, rd, rn) {}
+    };
+
+    static_assert(FmovRegister(reg::S0, reg::S1).Value() == 0x1E204020, "");
+    static_assert(FmovRegister(reg::D2, reg::D3).Value() == 0x1E604062, "");
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::opx111 {
+
+    struct FloatingPointDataProcessing2Source : public FloatingPointInstruction {
+
+        static constexpr u8 Op4 = 0b10;
+
+        ACCESSOR(Rm,        16, 21);
+        ACCESSOR(Opcode,    12, 16);
+        ACCESSOR(LocalOp4,  10, 12);
+        ACCESSOR(Rn,        5, 10);
+        ACCESSOR(Rd,        0, 5);
+
+        enum Opcode : u8 {
+            FMUL = 0b0000,
+            FDIV = 0b0001,
+            FADD = 0b0010,
+            FSUB = 0b0011,
+        };
+
+        constexpr FloatingPointDataProcessing2Source(Opcode opcode, reg::Register rd, reg::Register rn, reg::Register rm) : FloatingPointInstruction(rd) {
+            if(rd.Kind() != rn.Kind() || rd.Kind() != rm.Kind())
+                OperandOutOfRange();
+
+            SetRm(rm.Index());
+            SetOpcode(opcode);
+            SetLocalOp4(Op4);
+            SetRn(rn.Index());
+            SetRd(rd.Index());
+        }
+    };
+}
+
+#include "fadd.hpp"
+#include "fdiv.hpp"
+#include "fmul.hpp"
+#include "fsub.hpp"
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Fadd : public impl::opx111::FloatingPointDataProcessing2Source {
+
+        constexpr Fadd(reg::Register rd, reg::Register rn, reg::Register rm) : FloatingPointDataProcessing2Source(FADD, rd, rn, rm) {}
+    };
+
+    static_assert(Fadd(reg::S0, reg::S1, reg::S2).Value()     == 0x1E222820, "");
+    static_assert(Fadd(reg::D1, reg::D2, reg::D3).Value()     == 0x1E632841, "");
+}
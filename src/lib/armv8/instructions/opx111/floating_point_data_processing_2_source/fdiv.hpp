@@ -0,0 +1,14 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Fdiv : public impl::opx111::FloatingPointDataProcessing2Source {
+
+        constexpr Fdiv(reg::Register rd, reg::Register rn, reg::Register rm) : FloatingPointDataProcessing2Source(FDIV, rd, rn, rm) {}
+    };
+
+    static_assert(Fdiv(reg::D9, reg::D10, reg::D11).Value()   == 0x1E6B1949, "");
+    static_assert(Fdiv(reg::S10, reg::S11, reg::S12).Value()  == 0x1E2C196A, "");
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Fmul : public impl::opx111::FloatingPointDataProcessing2Source {
+
+        constexpr Fmul(reg::Register rd, reg::Register rn, reg::Register rm) : FloatingPointDataProcessing2Source(FMUL, rd, rn, rm) {}
+    };
+
+    static_assert(Fmul(reg::S6, reg::S7, reg::S8).Value()     == 0x1E2808E6, "");
+    static_assert(Fmul(reg::D7, reg::D8, reg::D9).Value()     == 0x1E690907, "");
+}
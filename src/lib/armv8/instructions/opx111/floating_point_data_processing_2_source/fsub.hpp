@@ -0,0 +1,14 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Fsub : public impl::opx111::FloatingPointDataProcessing2Source {
+
+        constexpr Fsub(reg::Register rd, reg::Register rn, reg::Register rm) : FloatingPointDataProcessing2Source(FSUB, rd, rn, rm) {}
+    };
+
+    static_assert(Fsub(reg::D3, reg::D4, reg::D5).Value()     == 0x1E653883, "");
+    static_assert(Fsub(reg::S4, reg::S5, reg::S6).Value()     == 0x1E2638A4, "");
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::opx111 {
+
+    struct FloatingPointIntegerConversion : public FloatingPointInstruction {
+
+        ACCESSOR(Rmode,     19, 21);
+        ACCESSOR(Opcode,    16, 19);
+        ACCESSOR(Op4,       10, 16);
+        ACCESSOR(Rn,        5, 10);
+        ACCESSOR(Rd,        0, 5);
+
+        constexpr FloatingPointIntegerConversion(u8 rmode, u8 opcode, reg::Register fp, reg::Register gp, reg::Register rd, reg::Register rn) : FloatingPointInstruction(fp) {
+            SetSf(gp.Is64());
+            SetRmode(rmode);
+            SetOpcode(opcode);
+            SetOp4(0);
+            SetRn(rn.Index());
+            SetRd(rd.Index());
+        }
+    };
+}
+
+#include "fmov_general.hpp"
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    /* Moves between a general purpose and a floating point register of the same size, without conversion. */
+    struct FmovGeneral : public impl::opx111::FloatingPointIntegerConversion {
+
+        static constexpr u8 Rmode = 0b00;
+        static constexpr u8 OpcodeToFp = 0b111;
+        static constexpr u8 OpcodeToGp = 0b110;
+
+        static constexpr reg::Register GetFp(reg::Register rd, reg::Register rn) {
+            if(rd.IsVector() == rn.IsVector() || rd.Size() != rn.Size())
+                impl::OperandOutOfRange();
+
+            return rd.IsVector() ? rd : rn;
+        }
+
+        static constexpr reg::Register GetGp(reg::Register rd, reg::Register rn) {
+            return rd.IsVector() ? rn : rd;
+        }
+
+        constexpr FmovGeneral(reg::Register rd, reg::Register rn) : FloatingPointIntegerConversion(
+            Rmode, rd.IsVector() ? OpcodeToFp : OpcodeToGp, GetFp(rd, rn), GetGp(rd, rn), rd, rn
+        ) {}
+    };
+
+    static_assert(FmovGeneral(reg::S0, reg::W1).Value() == 0x1E270020, "");
+    static_assert(FmovGeneral(reg::W2, reg::S3).Value() == 0x1E260062, "");
+    static_assert(FmovGeneral(reg::D4, reg::X5).Value() == 0x9E6700A4, "");
+    static_assert(FmovGeneral(reg::X6, reg::D7).Value() == 0x9E6600E6, "");
+}
@@ -2,6 +2,18 @@
 
 #include <lib/armv8.hpp>
 
+namespace exl::armv8::inst {
+
+    enum IndexMode : u8 {
+        /* [base, #imm] */
+        IndexMode_Offset    = 0b10,
+        /* [base, #imm]!, the base is updated before the access. */
+        IndexMode_PreIndex  = 0b11,
+        /* [base], #imm, the base is updated after the access. */
+        IndexMode_PostIndex = 0b01,
+    };
+}
+
 namespace exl::armv8::inst::impl {
 
     struct Opx1x0Instruction : public Instruction {
@@ -15,9 +27,36 @@ namespace exl::armv8::inst::impl {
         constexpr Opx1x0Instruction(u8 op0) : Instruction(0b0100) {
             SetOp0(op0);
         }
+
+        /* Size, V and opc of the single register loads and stores for a given transfer register. 128-bit vector
+           accesses borrow the top bit of opc. */
+        static constexpr u8 GetTransferSize(reg::Register rt) {
+            switch(rt.Kind()) {
+                case reg::RegisterKind::W:
+                case reg::RegisterKind::S:
+                    return 0b10;
+                case reg::RegisterKind::X:
+                case reg::RegisterKind::D:
+                    return 0b11;
+                case reg::RegisterKind::Q:
+                    return 0b00;
+            }
+            return 0b00;
+        }
+
+        static constexpr u8 GetTransferV(reg::Register rt) {
+            return rt.IsVector();
+        }
+
+        static constexpr u8 GetTransferOpc(reg::Register rt, bool load) {
+            return (rt.Kind() == reg::RegisterKind::Q ? 0b10 : 0b00) | load;
+        }
     };
 }
 
+#include "load_register_literal/base.hpp"
+#include "load_store_register_immediate_indexed/base.hpp"
 #include "load_store_register_offset/base.hpp"
+#include "load_store_register_pair/base.hpp"
 #include "load_store_register_unscaled_immediate/base.hpp"
 #include "load_store_register_unsigned_immediate/base.hpp"
\ No newline at end of file
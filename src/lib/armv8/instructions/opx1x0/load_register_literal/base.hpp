@@ -0,0 +1,41 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::opx1x0 {
+
+    struct LoadRegisterLiteral : public Opx1x0Instruction {
+
+        static constexpr u8 Op0 = 0b0001;
+        static constexpr u8 Op2 = 0b00;
+
+        ACCESSOR(Opc,   30, 32);
+        ACCESSOR(V,     26);
+        ACCESSOR(Imm19, 5, 24);
+        ACCESSOR(Rt,    0, 5);
+
+        static constexpr u8 GetOpc(reg::Register rt) {
+            switch(rt.Kind()) {
+                case reg::RegisterKind::W:
+                case reg::RegisterKind::S:
+                    return 0b00;
+                case reg::RegisterKind::X:
+                case reg::RegisterKind::D:
+                    return 0b01;
+                case reg::RegisterKind::Q:
+                    return 0b10;
+            }
+            return 0b00;
+        }
+
+        constexpr LoadRegisterLiteral(reg::Register rt, s64 relative_address) : Opx1x0Instruction(Op0) {
+            SetOp2(Op2);
+            SetOpc(GetOpc(rt));
+            SetV(rt.IsVector());
+            SetImm19(EncodeSignedOffset<Imm19Mask.Count, 4>(relative_address));
+            SetRt(rt.Index());
+        }
+    };
+}
+
+#include "ldr_literal.hpp"
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct LdrLiteral : public impl::opx1x0::LoadRegisterLiteral {
+
+        constexpr LdrLiteral(reg::Register rt, s64 relative_address) : LoadRegisterLiteral(rt, relative_address) {}
+    };
+
+    static_assert(LdrLiteral(reg::X17, 0x8).Value()     == 0x58000051, "");
+    static_assert(LdrLiteral(reg::W3, -0x8).Value()     == 0x18FFFFC3, "");
+    static_assert(LdrLiteral(reg::S0, 0x10).Value()     == 0x1C000080, "");
+    static_assert(LdrLiteral(reg::D1, 0x100).Value()    == 0x5C000801, "");
+    static_assert(LdrLiteral(reg::Q2, -0x10).Value()    == 0x9CFFFF82, "");
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::opx1x0 {
+
+    /* Pre and post-indexed forms, these share IndexMode's encoding in bits 10-11. */
+    struct LoadStoreRegisterImmediateIndexed : public Opx1x0Instruction {
+
+        static constexpr u8 Op0 = 0b0011;
+        static constexpr u8 Op2 = 0b00;
+
+        ACCESSOR(Size,      30, 32);
+        ACCESSOR(V,         26);
+        ACCESSOR(Opc,       22, 24);
+        ACCESSOR(Imm9,      12, 21);
+        ACCESSOR(Mode,      10, 12);
+        ACCESSOR(Rn,        5, 10);
+        ACCESSOR(Rt,        0, 5);
+
+        static constexpr InstType EncodeMode(IndexMode mode) {
+            if(mode == IndexMode_Offset)
+                OperandOutOfRange();
+
+            return mode;
+        }
+
+        constexpr LoadStoreRegisterImmediateIndexed(bool load, IndexMode mode, reg::Register rt, reg::Register rn, s16 imm9) : Opx1x0Instruction(Op0) {
+            SetOp2(Op2);
+            SetOp3(0);
+            SetSize(GetTransferSize(rt));
+            SetV(GetTransferV(rt));
+            SetOpc(GetTransferOpc(rt, load));
+            SetImm9(EncodeSignedOffset<Imm9Mask.Count>(imm9));
+            SetMode(EncodeMode(mode));
+            SetRn(rn.Index());
+            SetRt(rt.Index());
+        }
+    };
+}
+
+#include "ldr_register_indexed.hpp"
+#include "str_register_indexed.hpp"
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct LdrRegisterIndexed : public impl::opx1x0::LoadStoreRegisterImmediateIndexed {
+
+        constexpr LdrRegisterIndexed(reg::Register rt, reg::Register rn, s16 imm9, IndexMode mode) : LoadStoreRegisterImmediateIndexed(
+            true, mode, rt, rn, imm9
+        ) {}
+    };
+
+    static_assert(LdrRegisterIndexed(reg::X0, reg::SP, 16, IndexMode_PostIndex).Value()    == 0xF84107E0, "");
+    static_assert(LdrRegisterIndexed(reg::W3, reg::X4, -4, IndexMode_PostIndex).Value()    == 0xB85FC483, "");
+}
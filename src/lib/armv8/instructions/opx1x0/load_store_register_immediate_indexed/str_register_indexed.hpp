@@ -0,0 +1,16 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct StrRegisterIndexed : public impl::opx1x0::LoadStoreRegisterImmediateIndexed {
+
+        constexpr StrRegisterIndexed(reg::Register rt, reg::Register rn, s16 imm9, IndexMode mode) : LoadStoreRegisterImmediateIndexed(
+            false, mode, rt, rn, imm9
+        ) {}
+    };
+
+    static_assert(StrRegisterIndexed(reg::X0, reg::SP, -16, IndexMode_PreIndex).Value()    == 0xF81F0FE0, "");
+    static_assert(StrRegisterIndexed(reg::W1, reg::X2, 4, IndexMode_PreIndex).Value()      == 0xB8004C41, "");
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <lib/armv8.hpp>
+
+namespace exl::armv8::inst::impl::opx1x0 {
+
+    struct LoadStoreRegisterPair : public Opx1x0Instruction {
+
+        static constexpr u8 Op0 = 0b0010;
+
+        ACCESSOR(Opc,       30, 32);
+        ACCESSOR(V,         26);
+        ACCESSOR(IndexMode, 23, 25);
+        ACCESSOR(L,         22);
+        ACCESSOR(Imm7,      15, 22);
+        ACCESSOR(Rt2,       10, 15);
+        ACCESSOR(Rn,        5, 10);
+        ACCESSOR(Rt,        0, 5);
+
+        static constexpr u8 GetOpc(reg::Register rt) {
+            switch(rt.Kind()) {
+                case reg::RegisterKind::W:
+                case reg::RegisterKind::S:
+                    return 0b00;
+                case reg::RegisterKind::D:
+                    return 0b01;
+                case reg::RegisterKind::X:
+                case reg::RegisterKind::Q:
+                    return 0b10;
+            }
+            return 0b00;
+        }
+
+        /* The immediate is scaled by the size of one register. */
+        static constexpr InstType EncodeImm7(reg::Register rt, s16 imm) {
+            switch(rt.Size()) {
+                case 4:  return EncodeSignedOffset<Imm7Mask.Count, 4>(imm);
+                case 8:  return EncodeSignedOffset<Imm7Mask.Count, 8>(imm);
+                default: return EncodeSignedOffset<Imm7Mask.Count, 16>(imm);
+            }
+        }
+
+        constexpr LoadStoreRegisterPair(bool load, IndexMode mode, reg::Register rt, reg::Register rt2, reg::Register rn, s16 imm) : Opx1x0Instruction(Op0) {
+            if(rt.Kind() != rt2.Kind())
+                OperandOutOfRange();
+
+            SetOpc(GetOpc(rt));
+            SetV(rt.IsVector());
+            SetIndexMode(mode);
+            SetL(load);
+            SetImm7(EncodeImm7(rt, imm));
+            SetRt2(rt2.Index());
+            SetRn(rn.Index());
+            SetRt(rt.Index());
+        }
+    };
+}
+
+#include "ldp.hpp"
+#include "stp.hpp"
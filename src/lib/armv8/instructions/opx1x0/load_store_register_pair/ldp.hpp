@@ -0,0 +1,17 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Ldp : public impl::opx1x0::LoadStoreRegisterPair {
+
+        constexpr Ldp(reg::Register rt, reg::Register rt2, reg::Register rn, s16 imm = 0, IndexMode mode = IndexMode_Offset) : LoadStoreRegisterPair(
+            true, mode, rt, rt2, rn, imm
+        ) {}
+    };
+
+    static_assert(Ldp(reg::X29, reg::X30, reg::SP, 16, IndexMode_PostIndex).Value()    == 0xA8C17BFD, "");
+    static_assert(Ldp(reg::W2, reg::W3, reg::X4, 8).Value()                             == 0x29410C82, "");
+    static_assert(Ldp(reg::D8, reg::D9, reg::SP, -32, IndexMode_PreIndex).Value()       == 0x6DFE27E8, "");
+}
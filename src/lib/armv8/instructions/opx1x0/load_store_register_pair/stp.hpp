@@ -0,0 +1,17 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct Stp : public impl::opx1x0::LoadStoreRegisterPair {
+
+        constexpr Stp(reg::Register rt, reg::Register rt2, reg::Register rn, s16 imm = 0, IndexMode mode = IndexMode_Offset) : LoadStoreRegisterPair(
+            false, mode, rt, rt2, rn, imm
+        ) {}
+    };
+
+    static_assert(Stp(reg::X29, reg::X30, reg::SP, -16, IndexMode_PreIndex).Value()    == 0xA9BF7BFD, "");
+    static_assert(Stp(reg::X0, reg::X1, reg::SP, 16).Value()                            == 0xA90107E0, "");
+    static_assert(Stp(reg::Q0, reg::Q1, reg::SP, 0x100).Value()                         == 0xAD0807E0, "");
+}
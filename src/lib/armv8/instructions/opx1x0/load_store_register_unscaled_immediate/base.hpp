@@ -1,7 +1,6 @@
 #pragma once
 
 #include <lib/armv8.hpp>
-#include "util/math/sign_extend.hpp"
 
 namespace exl::armv8::inst::impl::opx1x0 {
 
@@ -26,7 +25,7 @@ namespace exl::armv8::inst::impl::opx1x0 {
             SetSize(size);
             SetV(v);
             SetOpc(opc);
-            SetImm9(util::SignExtend<Imm9Mask.Count>(imm9));
+            SetImm9(EncodeSignedOffset<Imm9Mask.Count>(imm9));
             SetRn(rn.Index());
             SetRt(rt.Index());
         }
@@ -6,15 +6,10 @@ namespace exl::armv8::inst {
 
     struct LdurUnscaledImmediate : public impl::opx1x0::LoadStoreRegisterUnscaledImmediate {
 
-        static constexpr bool V = 0b0;
-        static constexpr u8 Opc = 0b01;
-
-        static constexpr u8 GetSize(reg::Register rt) {
-            return 0b10 | rt.Is64();
-        }
+        static constexpr bool Load = true;
 
         constexpr LdurUnscaledImmediate(reg::Register rt, reg::Register rn, s16 imm9 = 0) : LoadStoreRegisterUnscaledImmediate(
-            GetSize(rt), V, Opc, imm9, rn, rt
+            GetTransferSize(rt), GetTransferV(rt), GetTransferOpc(rt, Load), imm9, rn, rt
         ) {}
     };
 
@@ -35,4 +30,6 @@ namespace exl::armv8::inst {
     static_assert(LdurUnscaledImmediate(reg::W28, reg::X29, -1).Value()     == 0xB85FF3BC, "");
     static_assert(LdurUnscaledImmediate(reg::X30, reg::SP, -5).Value()      == 0xF85FB3FE, "");
     static_assert(LdurUnscaledImmediate(reg::LR, reg::SP, -5).Value()       == 0xF85FB3FE, "");
+    static_assert(LdurUnscaledImmediate(reg::Q1, reg::X2, -16).Value()   == 0x3CDF0041, "");
+    static_assert(LdurUnscaledImmediate(reg::D3, reg::SP, 5).Value()     == 0xFC4053E3, "");
 }
\ No newline at end of file
@@ -6,15 +6,10 @@ namespace exl::armv8::inst {
 
     struct SturUnscaledImmediate : public impl::opx1x0::LoadStoreRegisterUnscaledImmediate {
 
-        static constexpr bool V = 0b0;
-        static constexpr u8 Opc = 0b00;
+        static constexpr bool Load = false;
 
-        static constexpr u8 GetSize(reg::Register rt) {
-            return 0b10 | rt.Is64();
-        }
-
-        constexpr SturUnscaledImmediate(reg::Register rt, reg::Register rn, u16 imm12 = 0) : LoadStoreRegisterUnscaledImmediate(
-            GetSize(rt), V, Opc, imm12, rn, rt
+        constexpr SturUnscaledImmediate(reg::Register rt, reg::Register rn, s16 imm9 = 0) : LoadStoreRegisterUnscaledImmediate(
+            GetTransferSize(rt), GetTransferV(rt), GetTransferOpc(rt, Load), imm9, rn, rt
         ) {}
     };
 
@@ -35,4 +30,6 @@ namespace exl::armv8::inst {
     static_assert(SturUnscaledImmediate(reg::W28, reg::X29, -1).Value()     == 0xB81FF3BC, "");
     static_assert(SturUnscaledImmediate(reg::X30, reg::SP, -5).Value()      == 0xF81FB3FE, "");
     static_assert(SturUnscaledImmediate(reg::LR, reg::SP, -5).Value()       == 0xF81FB3FE, "");
+    static_assert(SturUnscaledImmediate(reg::S4, reg::X5, -1).Value()    == 0xBC1FF0A4, "");
+    static_assert(SturUnscaledImmediate(reg::Q6, reg::X7, 255).Value()   == 0x3C8FF0E6, "");
 }
\ No newline at end of file
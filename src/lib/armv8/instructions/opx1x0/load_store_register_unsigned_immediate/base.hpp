@@ -1,7 +1,6 @@
 #pragma once
 
 #include <lib/armv8.hpp>
-#include "util/math/sign_extend.hpp"
 
 namespace exl::armv8::inst::impl::opx1x0 {
 
@@ -22,7 +21,7 @@ namespace exl::armv8::inst::impl::opx1x0 {
             SetSize(size);
             SetV(v);
             SetOpc(opc);
-            SetImm12(imm12);
+            SetImm12(EncodeUnsignedOffset<Imm12Mask.Count>(imm12));
             SetRn(rn.Index());
             SetRt(rt.Index());
         }
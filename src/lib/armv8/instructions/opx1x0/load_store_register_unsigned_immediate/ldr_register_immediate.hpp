@@ -6,15 +6,10 @@ namespace exl::armv8::inst {
 
     struct LdrRegisterImmediate : public impl::opx1x0::LoadStoreRegisterUnsignedImmediate {
 
-        static constexpr bool V = 0b0;
-        static constexpr u8 Opc = 0b01;
-
-        static constexpr u8 GetSize(reg::Register rt) {
-            return 0b10 | rt.Is64();
-        }
+        static constexpr bool Load = true;
 
         constexpr LdrRegisterImmediate(reg::Register rt, reg::Register rn, u16 imm12 = 0) : LoadStoreRegisterUnsignedImmediate(
-            GetSize(rt), V, Opc, imm12, rn, rt
+            GetTransferSize(rt), GetTransferV(rt), GetTransferOpc(rt, Load), imm12, rn, rt
         ) {}
     };
 
@@ -35,4 +30,6 @@ namespace exl::armv8::inst {
     static_assert(LdrRegisterImmediate(reg::W28, reg::X29).Value()      == 0xB94003BC, "");
     static_assert(LdrRegisterImmediate(reg::X30, reg::SP).Value()       == 0xF94003FE, "");
     static_assert(LdrRegisterImmediate(reg::LR, reg::SP).Value()        == 0xF94003FE, "");
+    static_assert(LdrRegisterImmediate(reg::Q0, reg::SP, 1).Value()     == 0x3DC007E0, "");
+    static_assert(LdrRegisterImmediate(reg::S1, reg::X2, 1).Value()     == 0xBD400441, "");
 }
\ No newline at end of file
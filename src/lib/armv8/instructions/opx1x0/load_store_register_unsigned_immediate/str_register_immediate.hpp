@@ -6,15 +6,10 @@ namespace exl::armv8::inst {
 
     struct StrRegisterImmediate : public impl::opx1x0::LoadStoreRegisterUnsignedImmediate {
 
-        static constexpr bool V = 0b0;
-        static constexpr u8 Opc = 0b00;
-
-        static constexpr u8 GetSize(reg::Register rt) {
-            return 0b10 | rt.Is64();
-        }
+        static constexpr bool Load = false;
 
         constexpr StrRegisterImmediate(reg::Register rt, reg::Register rn, u16 imm12 = 0) : LoadStoreRegisterUnsignedImmediate(
-            GetSize(rt), V, Opc, imm12, rn, rt
+            GetTransferSize(rt), GetTransferV(rt), GetTransferOpc(rt, Load), imm12, rn, rt
         ) {}
     };
 
@@ -35,4 +30,6 @@ namespace exl::armv8::inst {
     static_assert(StrRegisterImmediate(reg::W28, reg::X29).Value()      == 0xB90003BC, "");
     static_assert(StrRegisterImmediate(reg::X30, reg::SP).Value()       == 0xF90003FE, "");
     static_assert(StrRegisterImmediate(reg::LR, reg::SP).Value()        == 0xF90003FE, "");
+    static_assert(StrRegisterImmediate(reg::D8, reg::X0, 1).Value()     == 0xFD000408, "");
+    static_assert(StrRegisterImmediate(reg::Q3, reg::SP).Value()        == 0x3D8003E3, "");
 }
\ No newline at end of file
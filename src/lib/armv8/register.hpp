@@ -1,41 +1,71 @@
 #pragma once
 
-#include <lib.hpp>
+#include <common.hpp>
 
 namespace exl::armv8::reg {
     
-    enum class RegisterKind : bool {
-        W, X
+    enum class RegisterKind : u8 {
+        /* General purpose. */
+        W, X,
+        /* FP/SIMD, as 32, 64 and 128-bit scalars. */
+        S, D, Q,
     };
 
     class Register {
         private:
-        /* Pack members efficiently. */
-        RegisterKind m_Kind : 1;
-        char m_Index : 7;
+        RegisterKind m_Kind;
+        char m_Index;
 
         public:
         constexpr Register(RegisterKind kind, uchar index) : m_Kind(kind), m_Index(index) { }
 
+        constexpr inline RegisterKind Kind() const { return m_Kind; }
         constexpr inline bool Is32() const { return m_Kind == RegisterKind::W; }
         constexpr inline bool Is64() const { return m_Kind == RegisterKind::X; }
+        constexpr inline bool IsVector() const { return m_Kind >= RegisterKind::S; }
         constexpr inline uchar Index() const { return m_Index; }
+
+        /* Access size in bytes. */
+        constexpr inline uchar Size() const {
+            switch(m_Kind) {
+                case RegisterKind::W: return 4;
+                case RegisterKind::X: return 8;
+                case RegisterKind::S: return 4;
+                case RegisterKind::D: return 8;
+                case RegisterKind::Q: return 16;
+            }
+            return 0;
+        }
     };
-    static_assert(sizeof(Register) == 1, "Register");
+    static_assert(sizeof(Register) == 2, "Register");
 
     #define REG(I)                                          \
         constexpr inline Register W##I(RegisterKind::W, I); \
         constexpr inline Register X##I(RegisterKind::X, I);
 
+    #define VREG(I)                                         \
+        constexpr inline Register S##I(RegisterKind::S, I); \
+        constexpr inline Register D##I(RegisterKind::D, I); \
+        constexpr inline Register Q##I(RegisterKind::Q, I);
+
     REG(0); REG(1); REG(2); REG(3); REG(4); REG(5); REG(6); REG(7); REG(8); REG(9); 
     REG(10);REG(11);REG(12);REG(13);REG(14);REG(15);REG(16);REG(17);REG(18);REG(19);
     REG(20);REG(21);REG(22);REG(23);REG(24);REG(25);REG(26);REG(27);REG(28);REG(29);
     REG(30);
 
+    VREG(0); VREG(1); VREG(2); VREG(3); VREG(4); VREG(5); VREG(6); VREG(7); VREG(8); VREG(9);
+    VREG(10);VREG(11);VREG(12);VREG(13);VREG(14);VREG(15);VREG(16);VREG(17);VREG(18);VREG(19);
+    VREG(20);VREG(21);VREG(22);VREG(23);VREG(24);VREG(25);VREG(26);VREG(27);VREG(28);VREG(29);
+    VREG(30);VREG(31);
+
     constexpr inline auto LR = X30;
     constexpr inline auto SP = Register(RegisterKind::X, 31);
+    /* Same encoding as SP, which one an operand means depends on the instruction. */
+    constexpr inline auto XZR = Register(RegisterKind::X, 31);
+    constexpr inline auto WZR = Register(RegisterKind::W, 31);
     constexpr inline auto None32 = Register(RegisterKind::W, -1);
     constexpr inline auto None64 = Register(RegisterKind::X, -1);
 
     #undef REG
+    #undef VREG
 }
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include "heap.hpp"
+
+#include "lib/diag/assert.hpp"
+#include "program/setting.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+namespace exl::heap {
+
+    namespace {
+        constexpr size_t MaxPages = setting::HeapSize / PAGE_SIZE;
+        static_assert(MaxPages != 0, "Heap must be at least a page");
+        static_assert(MaxPages <= std::numeric_limits<u16>::max(), "");
+
+        /* Anything below SizeClassCount is the size class a page belongs to. */
+        constexpr u8 PageFree = 0xFF;
+        constexpr u8 PageLarge = 0xFE;
+        constexpr u8 PageLargeTail = 0xFD;
+        static_assert(SizeClassCount < PageLargeTail, "");
+
+        /* Chunks are named by their offset from the heap base in DefaultAlignment units, plus one so zero ends a list. */
+        constexpr u32 NoChunk = 0;
+        static_assert(MaxPages * PAGE_SIZE / DefaultAlignment < std::numeric_limits<u32>::max(), "");
+
+        struct FreeChunk {
+            /* Atomic because a popping thread may read it while another thread already handed the chunk out. */
+            std::atomic<u32> m_Next;
+        };
+
+        /* Read without any synchronization by GetStats. */
+        struct Counters {
+            std::atomic<size_t> m_InUse = 0;
+            std::atomic<size_t> m_PeakInUse = 0;
+            std::atomic<size_t> m_Pages = 0;
+            std::atomic<u64> m_Allocations = 0;
+            std::atomic<u64> m_Failures = 0;
+
+            void OnAllocate() {
+                m_Allocations.fetch_add(1, std::memory_order_relaxed);
+                size_t inUse = m_InUse.fetch_add(1, std::memory_order_relaxed) + 1;
+                size_t peak = m_PeakInUse.load(std::memory_order_relaxed);
+                while(inUse > peak && !m_PeakInUse.compare_exchange_weak(peak, inUse, std::memory_order_relaxed));
+            }
+
+            void OnFree() {
+                m_InUse.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            void Read(ClassStats* out, size_t chunk_size) const {
+                *out = {
+                    .m_ChunkSize = chunk_size,
+                    .m_InUse = m_InUse.load(std::memory_order_relaxed),
+                    .m_PeakInUse = m_PeakInUse.load(std::memory_order_relaxed),
+                    .m_Pages = m_Pages.load(std::memory_order_relaxed),
+                    .m_Allocations = m_Allocations.load(std::memory_order_relaxed),
+                    .m_Failures = m_Failures.load(std::memory_order_relaxed),
+                };
+            }
+        };
+
+        /* Nothing in here ever waits on another thread. Horizon schedules strictly by priority, so a thread spinning */
+        /* on a lock held by a preempted lower priority thread on the same core would never let it run again. */
+        struct SizeClass {
+            /* Free list head, the chunk in the low half and a count of head changes in the high half. The count */
+            /* makes a pop fail if the head was popped and pushed back in between, instead of linking a stale next. */
+            std::atomic<u64> m_Head = NoChunk;
+            Counters m_Counters;
+        };
+
+        constinit std::array<SizeClass, SizeClassCount> s_Classes {};
+        constinit Counters s_LargeCounters {};
+
+        constinit uintptr_t s_Base = 0;
+        constinit size_t s_PageCount = 0;
+        /* Pages are claimed one by one with a compare exchange from PageFree. */
+        constinit std::array<std::atomic<u8>, MaxPages> s_PageKinds {};
+        /* Length of each large allocation, at its first page. Written before the first page is published. */
+        constinit std::array<u16, MaxPages> s_LargePageCounts {};
+        constinit std::atomic<size_t> s_UsedPages = 0;
+        constinit std::atomic<size_t> s_PeakUsedPages = 0;
+
+        size_t GetPageIndex(const void* ptr) {
+            const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+            EXL_ASSERT(s_Base <= address && address < s_Base + s_PageCount * PAGE_SIZE);
+            return (address - s_Base) / PAGE_SIZE;
+        }
+
+        u32 ToChunkId(const void* ptr) {
+            return (reinterpret_cast<uintptr_t>(ptr) - s_Base) / DefaultAlignment + 1;
+        }
+
+        FreeChunk* FromChunkId(u32 id) {
+            return reinterpret_cast<FreeChunk*>(s_Base + (id - 1) * DefaultAlignment);
+        }
+
+        /* Links first through last, which are already chained together, in front of the list. */
+        void PushChunks(SizeClass& sizeClass, FreeChunk* first, FreeChunk* last) {
+            const u32 firstId = ToChunkId(first);
+            u64 head = sizeClass.m_Head.load(std::memory_order_relaxed);
+            do {
+                last->m_Next.store(static_cast<u32>(head), std::memory_order_relaxed);
+            } while(!sizeClass.m_Head.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | firstId,
+                                                            std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        FreeChunk* PopChunk(SizeClass& sizeClass) {
+            u64 head = sizeClass.m_Head.load(std::memory_order_acquire);
+            while(true) {
+                const u32 id = static_cast<u32>(head);
+                if(id == NoChunk)
+                    return nullptr;
+
+                /* Heap memory stays mapped, so reading a chunk someone else just took is harmless, the exchange fails. */
+                const u32 next = FromChunkId(id)->m_Next.load(std::memory_order_relaxed);
+                if(sizeClass.m_Head.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | next,
+                                                          std::memory_order_acquire, std::memory_order_acquire))
+                    return FromChunkId(id);
+            }
+        }
+
+        void ReleasePages(size_t first, size_t count) {
+            for(size_t i = first; i < first + count; i++)
+                s_PageKinds[i].store(PageFree, std::memory_order_release);
+        }
+
+        /* Returns how many pages were claimed before one was found taken, those are handed back again. */
+        size_t ClaimPages(size_t first, size_t count) {
+            for(size_t i = 0; i < count; i++) {
+                u8 expected = PageFree;
+                if(!s_PageKinds[first + i].compare_exchange_strong(expected, PageLargeTail, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    ReleasePages(first, i);
+                    return i;
+                }
+            }
+            return count;
+        }
+
+        /* First fit, the heap is small enough that a linear walk of the page map is cheap. A run that is being */
+        /* claimed by another thread at the same time is skipped, so an allocation racing a nearly full heap may fail. */
+        void* AllocatePages(size_t count, u8 kind) {
+            size_t run = 0;
+            for(size_t i = 0; i < s_PageCount; i++) {
+                if(s_PageKinds[i].load(std::memory_order_relaxed) != PageFree) {
+                    run = 0;
+                    continue;
+                }
+
+                if(++run != count)
+                    continue;
+
+                const size_t first = i + 1 - count;
+                const size_t claimed = ClaimPages(first, count);
+                if(claimed != count) {
+                    /* Look again after the page another thread took. */
+                    i = first + claimed;
+                    run = 0;
+                    continue;
+                }
+
+                s_LargePageCounts[first] = count;
+                s_PageKinds[first].store(kind, std::memory_order_release);
+
+                size_t used = s_UsedPages.fetch_add(count, std::memory_order_relaxed) + count;
+                size_t peak = s_PeakUsedPages.load(std::memory_order_relaxed);
+                while(used > peak && !s_PeakUsedPages.compare_exchange_weak(peak, used, std::memory_order_relaxed));
+
+                return reinterpret_cast<void*>(s_Base + first * PAGE_SIZE);
+            }
+
+            return nullptr;
+        }
+
+        void FreeLargePages(size_t first) {
+            const size_t count = s_LargePageCounts[first];
+            ReleasePages(first, count);
+            s_UsedPages.fetch_sub(count, std::memory_order_relaxed);
+            s_LargeCounters.m_Pages.fetch_sub(count, std::memory_order_relaxed);
+        }
+
+        /* Returns SizeClassCount when the size needs whole pages. */
+        size_t GetClassIndex(size_t size, size_t alignment) {
+            for(size_t i = 0; i < SizeClassCount; i++) {
+                /* Runs start on a page, so a chunk is as aligned as its size allows. */
+                if(size <= SizeClasses[i] && SizeClasses[i] % alignment == 0)
+                    return i;
+            }
+            return SizeClassCount;
+        }
+
+        /* Threads that find the list empty at the same time each add a run, the extra chunks just stay free. */
+        bool RefillClass(size_t index) {
+            auto& sizeClass = s_Classes[index];
+            const size_t chunkSize = SizeClasses[index];
+
+            u8* run = static_cast<u8*>(AllocatePages(1, static_cast<u8>(index)));
+            if(run == nullptr)
+                return false;
+
+            sizeClass.m_Counters.m_Pages.fetch_add(1, std::memory_order_relaxed);
+
+            /* Chained in address order and published with a single exchange. */
+            const size_t chunkCount = PAGE_SIZE / chunkSize;
+            for(size_t i = 0; i + 1 < chunkCount; i++)
+                reinterpret_cast<FreeChunk*>(run + i * chunkSize)->m_Next.store(ToChunkId(run + (i + 1) * chunkSize), std::memory_order_relaxed);
+
+            PushChunks(sizeClass, reinterpret_cast<FreeChunk*>(run), reinterpret_cast<FreeChunk*>(run + (chunkCount - 1) * chunkSize));
+            return true;
+        }
+
+        void* AllocateSmall(size_t index) {
+            auto& sizeClass = s_Classes[index];
+
+            FreeChunk* chunk = PopChunk(sizeClass);
+            while(chunk == nullptr) {
+                if(!RefillClass(index)) {
+                    sizeClass.m_Counters.m_Failures.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                chunk = PopChunk(sizeClass);
+            }
+
+            sizeClass.m_Counters.OnAllocate();
+            return chunk;
+        }
+
+        void* AllocateLarge(size_t size) {
+            const size_t count = ALIGN_UP(size, PAGE_SIZE) / PAGE_SIZE;
+
+            void* ptr = count <= s_PageCount ? AllocatePages(count, PageLarge) : nullptr;
+            if(ptr == nullptr) {
+                s_LargeCounters.m_Failures.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            s_LargeCounters.m_Pages.fetch_add(count, std::memory_order_relaxed);
+            s_LargeCounters.OnAllocate();
+            return ptr;
+        }
+    }
+
+    void* Allocate(size_t size, size_t alignment) {
+        EXL_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0 && alignment <= PAGE_SIZE);
+
+        alignment = std::max(alignment, DefaultAlignment);
+        /* Every allocation gets its own address, even empty ones. */
+        size = std::max<size_t>(size, 1);
+
+        const size_t index = GetClassIndex(size, alignment);
+        if(index != SizeClassCount)
+            return AllocateSmall(index);
+
+        return AllocateLarge(size);
+    }
+
+    void Free(void* ptr) {
+        if(ptr == nullptr)
+            return;
+
+        const size_t page = GetPageIndex(ptr);
+        const u8 kind = s_PageKinds[page].load(std::memory_order_acquire);
+
+        if(kind == PageLarge) {
+            EXL_ASSERT(reinterpret_cast<uintptr_t>(ptr) % PAGE_SIZE == 0);
+            s_LargeCounters.OnFree();
+            FreeLargePages(page);
+            return;
+        }
+
+        EXL_ASSERT(kind < SizeClassCount);
+
+        auto& sizeClass = s_Classes[kind];
+        auto chunk = static_cast<FreeChunk*>(ptr);
+        PushChunks(sizeClass, chunk, chunk);
+        sizeClass.m_Counters.OnFree();
+    }
+
+    void* Reallocate(void* ptr, size_t size) {
+        if(ptr == nullptr)
+            return Allocate(size);
+
+        if(size == 0) {
+            Free(ptr);
+            return nullptr;
+        }
+
+        const size_t usable = GetUsableSize(ptr);
+        if(size <= usable)
+            return ptr;
+
+        void* moved = Allocate(size);
+        if(moved == nullptr)
+            return nullptr;
+
+        std::memcpy(moved, ptr, usable);
+        Free(ptr);
+        return moved;
+    }
+
+    size_t GetUsableSize(const void* ptr) {
+        if(ptr == nullptr)
+            return 0;
+
+        const size_t page = GetPageIndex(ptr);
+        const u8 kind = s_PageKinds[page].load(std::memory_order_acquire);
+
+        if(kind == PageLarge)
+            return s_LargePageCounts[page] * PAGE_SIZE;
+
+        EXL_ASSERT(kind < SizeClassCount);
+        return SizeClasses[kind];
+    }
+
+    bool IsInitialized() {
+        return s_PageCount != 0;
+    }
+
+    void GetStats(Stats* out) {
+        for(size_t i = 0; i < SizeClassCount; i++)
+            s_Classes[i].m_Counters.Read(&out->m_Classes[i], SizeClasses[i]);
+        s_LargeCounters.Read(&out->m_Large, 0);
+
+        out->m_TotalPages = s_PageCount;
+        out->m_UsedPages = s_UsedPages.load(std::memory_order_relaxed);
+        out->m_PeakUsedPages = s_PeakUsedPages.load(std::memory_order_relaxed);
+    }
+
+    void ResetPeaks() {
+        for(auto& sizeClass : s_Classes)
+            sizeClass.m_Counters.m_PeakInUse.store(sizeClass.m_Counters.m_InUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        s_LargeCounters.m_PeakInUse.store(s_LargeCounters.m_InUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        s_PeakUsedPages.store(s_UsedPages.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    namespace impl {
+        void InitHeap(void* region, size_t size) {
+            const uintptr_t start = ALIGN_UP(reinterpret_cast<uintptr_t>(region), PAGE_SIZE);
+            const uintptr_t end = reinterpret_cast<uintptr_t>(region) + size;
+            EXL_ASSERT(start < end);
+
+            for(auto& kind : s_PageKinds)
+                kind.store(PageFree, std::memory_order_relaxed);
+            s_Base = start;
+            s_PageCount = std::min((end - start) / PAGE_SIZE, MaxPages);
+        }
+    }
+}
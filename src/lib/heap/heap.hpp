@@ -0,0 +1,55 @@
+#pragma once
+
+#include <common.hpp>
+
+#include <array>
+
+namespace exl::heap {
+
+    /* Every allocation is at least this aligned, like malloc. */
+    static constexpr size_t DefaultAlignment = 0x10;
+
+    /* Requests up to the largest class are served from page sized runs of equal chunks, anything larger takes whole pages. */
+    static constexpr std::array SizeClasses = std::to_array<size_t>({
+        0x10, 0x20, 0x30, 0x40, 0x60, 0x80, 0xC0, 0x100, 0x180, 0x200, 0x300, 0x400, 0x600, 0x800,
+    });
+    static constexpr size_t SizeClassCount = SizeClasses.size();
+    static constexpr size_t MaxSmallSize = SizeClasses.back();
+
+    struct ClassStats {
+        /* Chunk size for size classes, zero for the large allocations. */
+        size_t m_ChunkSize;
+        /* Live allocations and their high-water mark. */
+        size_t m_InUse;
+        size_t m_PeakInUse;
+        /* Pages taken, for the large allocations these are the pages of the live ones. */
+        size_t m_Pages;
+        u64 m_Allocations;
+        u64 m_Failures;
+    };
+
+    struct Stats {
+        std::array<ClassStats, SizeClassCount> m_Classes;
+        ClassStats m_Large;
+        size_t m_TotalPages;
+        size_t m_UsedPages;
+        size_t m_PeakUsedPages;
+    };
+
+    /* Returns nullptr when out of memory. Alignment must be a power of two no larger than a page. */
+    void* Allocate(size_t size, size_t alignment = DefaultAlignment);
+    void Free(void* ptr);
+    /* Grows or shrinks in place when the new size still fits, ptr may be nullptr. */
+    void* Reallocate(void* ptr, size_t size);
+    size_t GetUsableSize(const void* ptr);
+
+    bool IsInitialized();
+    void GetStats(Stats* out);
+    /* Lowers every high-water mark to the current value. */
+    void ResetPeaks();
+
+    namespace impl {
+        /* Pages that a run of a size class has taken are kept by that class. */
+        void InitHeap(void* region, size_t size);
+    }
+}
@@ -0,0 +1,92 @@
+#include "heap.hpp"
+
+#include "program/setting.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef EXL_USE_FAKEHEAP
+
+/* Replaces newlib's allocator, so malloc and operator new are served by exl::heap. newlib calls the reentrant
+   versions directly from within itself, those are replaced as well so nothing ends up on a second heap. */
+
+struct _reent;
+
+extern "C" {
+
+    void* malloc(size_t size) {
+        return exl::heap::Allocate(size);
+    }
+
+    void free(void* ptr) {
+        exl::heap::Free(ptr);
+    }
+
+    void* calloc(size_t count, size_t size) {
+        size_t total;
+        if(__builtin_mul_overflow(count, size, &total))
+            return nullptr;
+
+        void* ptr = exl::heap::Allocate(total);
+        if(ptr != nullptr)
+            std::memset(ptr, 0, total);
+        return ptr;
+    }
+
+    void* realloc(void* ptr, size_t size) {
+        return exl::heap::Reallocate(ptr, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) {
+        if(alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > PAGE_SIZE)
+            return nullptr;
+
+        return exl::heap::Allocate(size, alignment);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) {
+        return memalign(alignment, size);
+    }
+
+    int posix_memalign(void** out, size_t alignment, size_t size) {
+        if(alignment % sizeof(void*) != 0)
+            return EINVAL;
+
+        void* ptr = memalign(alignment, size);
+        if(ptr == nullptr)
+            return alignment > PAGE_SIZE || (alignment & (alignment - 1)) != 0 ? EINVAL : ENOMEM;
+
+        *out = ptr;
+        return 0;
+    }
+
+    size_t malloc_usable_size(void* ptr) {
+        return exl::heap::GetUsableSize(ptr);
+    }
+
+    void* _malloc_r(_reent*, size_t size) {
+        return malloc(size);
+    }
+
+    void _free_r(_reent*, void* ptr) {
+        free(ptr);
+    }
+
+    void* _calloc_r(_reent*, size_t count, size_t size) {
+        return calloc(count, size);
+    }
+
+    void* _realloc_r(_reent*, void* ptr, size_t size) {
+        return realloc(ptr, size);
+    }
+
+    void* _memalign_r(_reent*, size_t alignment, size_t size) {
+        return memalign(alignment, size);
+    }
+
+    size_t _malloc_usable_size_r(_reent*, void* ptr) {
+        return malloc_usable_size(ptr);
+    }
+}
+
+#endif
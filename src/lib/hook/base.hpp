@@ -29,6 +29,21 @@ namespace exl::hook {
     inline void Initialize() {
         arch::Initialize();
     }
+
+    using TrampolineStats = arch::TrampolineStats;
+
+    inline TrampolineStats GetTrampolineStats() {
+        return arch::GetTrampolineStats();
+    }
+
+    /* Batches every hook installed during its lifetime, writing them all out on destruction. */
+    class Transaction {
+        NON_COPYABLE(Transaction);
+        NON_MOVEABLE(Transaction);
+        public:
+        Transaction() { arch::BeginTransaction(); }
+        ~Transaction() { arch::CommitTransaction(); }
+    };
     
     template<typename InFunc, typename CbFunc>
     CbFunc Hook(InFunc hook, CbFunc callback, bool do_trampoline = false) {
@@ -50,10 +65,36 @@ namespace exl::hook {
         return ret;
     }
 
+    inline Result EnableHook(uintptr_t hook) {
+        return arch::EnableHook(hook);
+    }
+
+    inline Result DisableHook(uintptr_t hook) {
+        return arch::DisableHook(hook);
+    }
+
+    inline Result UninstallHook(uintptr_t hook) {
+        return arch::UninstallHook(hook);
+    }
+
+    inline bool IsHookEnabled(uintptr_t hook) {
+        return arch::IsHookEnabled(hook);
+    }
+
     using InlineCtx = arch::InlineCtx;
     using InlineCallback = void (*)(InlineCtx*);
 
     inline void HookInline(uintptr_t hook, InlineCallback callback) {
         arch::HookInline(hook, reinterpret_cast<uintptr_t>(callback));
     }
+
+    /* Bit n selects Xn, for HookInlineMasked. */
+    template<typename... Registers>
+    consteval u32 MakeRegisterMask(Registers... registers) {
+        return ((1u << registers.Index()) | ... | 0u);
+    }
+
+    inline void HookInlineMasked(uintptr_t hook, InlineCallback callback, u32 registers, bool save_neon = false) {
+        arch::HookInlineMasked(hook, reinterpret_cast<uintptr_t>(callback), registers, save_neon);
+    }
 }
\ No newline at end of file
@@ -7,6 +7,11 @@
 #define HOOK_DEFINE_INLINE(name)                        \
 struct name : public ::exl::hook::impl::InlineHook<name>
 
+/* The hook must declare static constexpr u32 Registers, built with exl::hook::MakeRegisterMask, */
+/* and may declare static constexpr bool SaveNeon. Registers outside the mask read as garbage in the context. */
+#define HOOK_DEFINE_MASKED_INLINE(name)                 \
+struct name : public ::exl::hook::impl::MaskedInlineHook<name>
+
 namespace exl::hook::impl {
 
     template<typename Derived>
@@ -15,17 +20,66 @@ namespace exl::hook::impl {
         template<typename T = Derived>
         using CallbackFuncPtr = decltype(&T::Callback);
 
+        static ALWAYS_INLINE auto& AddressRef() {
+            static constinit uintptr_t s_Address = 0;
+
+            return s_Address;
+        }
+
         static ALWAYS_INLINE void InstallAtOffset(ptrdiff_t address) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
-            hook::HookInline(util::modules::GetTargetStart() + address, Derived::Callback);
+            AddressRef() = util::modules::GetTargetStart() + address;
+            hook::HookInline(AddressRef(), Derived::Callback);
         }
 
         static ALWAYS_INLINE void InstallAtPtr(uintptr_t ptr) {
             _HOOK_STATIC_CALLBACK_ASSERT();
             
+            AddressRef() = ptr;
             hook::HookInline(ptr, Derived::Callback);
         }
 
+        static ALWAYS_INLINE Result Enable() {
+            return hook::EnableHook(AddressRef());
+        }
+
+        static ALWAYS_INLINE Result Disable() {
+            return hook::DisableHook(AddressRef());
+        }
+
+        static ALWAYS_INLINE Result Uninstall() {
+            return hook::UninstallHook(AddressRef());
+        }
+
+        static ALWAYS_INLINE bool IsEnabled() {
+            return hook::IsHookEnabled(AddressRef());
+        }
+
+    };
+
+    template<typename Derived>
+    struct MaskedInlineHook : public InlineHook<Derived> {
+
+        using InlineHook<Derived>::AddressRef;
+
+        static constexpr bool GetSaveNeon() {
+            if constexpr (requires { Derived::SaveNeon; })
+                return Derived::SaveNeon;
+            else
+                return false;
+        }
+
+        static ALWAYS_INLINE void InstallAtOffset(ptrdiff_t address) {
+            InstallAtPtr(util::modules::GetTargetStart() + address);
+        }
+
+        static ALWAYS_INLINE void InstallAtPtr(uintptr_t ptr) {
+            static_assert(!std::is_member_function_pointer_v<decltype(&Derived::Callback)>, "Callback method must be static!");
+            static_assert(std::is_same_v<std::remove_cv_t<decltype(Derived::Registers)>, u32>, "Registers must be a u32 mask!");
+
+            AddressRef() = ptr;
+            hook::HookInlineMasked(ptr, Derived::Callback, Derived::Registers, GetSaveNeon());
+        }
     };
-}
\ No newline at end of file
+}
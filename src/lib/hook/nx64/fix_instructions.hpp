@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace exl::hook::nx64 {
+
+    /* Most instructions a trampoline can relocate, the hook branch covers at most this many. */
+    constexpr int64_t MaxInstructions = 5;
+    constexpr uint32_t Aarch64Nop = 0xd503201f;
+
+    /* Copies count instructions into a trampoline followed by a branch back, rewriting every PC-relative one so it */
+    /* still reaches its original target. inprw/outrwp are where to read/write, inprx/outrxp where the code executes. */
+    /* Returns false if count is more than MaxInstructions. Nothing here touches the kernel or memory mappings. */
+    bool __fix_instructions(uint32_t* inprw, uint32_t* inprx, int32_t count,
+                                uint32_t* __restrict outrwp, uint32_t* __restrict outrxp);
+}
@@ -27,11 +27,16 @@
  SOFTWARE.
  */
 #define __STDC_FORMAT_MACROS
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <stdlib.h>
 
+#include "lib.hpp"
 #include "util/sys/jit.hpp"
-#include "inline_impl.hpp"
+#include "fix_instructions.hpp"
+#include "impl.hpp"
 
 
 #define __attribute __attribute__
@@ -50,15 +55,18 @@
 
 namespace exl::hook::nx64 {
 
+    namespace reg = exl::armv8::reg;
+    namespace inst = exl::armv8::inst;
+
     namespace {
 
         // Hooking constants
         constexpr size_t HookPoolSize = setting::JitSize;
-        constexpr s64 MaxInstructions = 5;
+        constexpr size_t HookPoolCount = setting::JitBlockCount;
         constexpr size_t TrampolineSize = MaxInstructions * 10;
         constexpr u64 HookMax = HookPoolSize / (TrampolineSize * sizeof(uint32_t));
-        constexpr u64 MaxReferences = MaxInstructions * 2;
-        constexpr u32 Aarch64Nop = 0xd503201f;
+
+        constexpr u64 HookTotalMax = HookMax * HookPoolCount;
 
         typedef uint32_t HookPool[HookMax][TrampolineSize];
         static_assert(sizeof(HookPool) <= HookPoolSize, "");
@@ -76,531 +84,425 @@ namespace exl::hook::nx64 {
         constexpr size_t InlineHookMax = 1;
         constexpr size_t InlineHookPoolSize = InlineHookSize * InlineHookMax;
 
-        typedef uint32_t* __restrict* __restrict instruction;
-        typedef struct {
-            struct fix_info {
-                uint32_t* bprx;
-                uint32_t* bprw;
-                uint32_t ls;  // left-shift counts
-                uint32_t ad;  // & operand
-            };
-            struct insns_info {
-                union {
-                    uint64_t insu;
-                    int64_t ins;
-                    void* insp;
-                };
-                fix_info fmap[MaxReferences];
-            };
-            int64_t basep;
-            int64_t endp;
-            insns_info dat[MaxInstructions];
-
-        public:
-            inline bool is_in_fixing_range(const int64_t absolute_addr) {
-                return absolute_addr >= this->basep && absolute_addr < this->endp;
-            }
-            inline intptr_t get_ref_ins_index(const int64_t absolute_addr) {
-                return static_cast<intptr_t>((absolute_addr - this->basep) / sizeof(uint32_t));
-            }
-            inline intptr_t get_and_set_current_index(uint32_t* __restrict inp, uint32_t* __restrict outp) {
-                intptr_t current_idx = this->get_ref_ins_index(reinterpret_cast<int64_t>(inp));
-                this->dat[current_idx].insp = outp;
-                return current_idx;
-            }
-            inline void reset_current_ins(const intptr_t idx, uint32_t* __restrict outp) { this->dat[idx].insp = outp; }
-            void insert_fix_map(const intptr_t idx, uint32_t* bprw, uint32_t* bprx, uint32_t ls = 0u, uint32_t ad = 0xffffffffu) {
-                for (auto& f : this->dat[idx].fmap) {
-                    if (f.bprw == NULL) {
-                        f.bprw = bprw;
-                        f.bprx = bprx;
-                        f.ls = ls;
-                        f.ad = ad;
-                        return;
-                    }  // if
-                }
-                // What? GGing..
-            }
-            void process_fix_map(const intptr_t idx) {
-                for (auto& f : this->dat[idx].fmap) {
-                    if (f.bprw == NULL) break;
-                    *(f.bprw) =
-                        *(f.bprx) | (((int32_t(this->dat[idx].ins - reinterpret_cast<int64_t>(f.bprx)) >> 2) << f.ls) & f.ad);
-                    f.bprw = NULL;
-                    f.bprx = NULL;
-                }
+    }
+
+    //-------------------------------------------------------------------------
+
+    //static nn::os::MutexType hookMutex;
+
+    //-------------------------------------------------------------------------
+
+    JIT_POOL_CREATE(s_HookJit, setting::JitSize, setting::JitBlockCount);
+
+    static std::atomic<u64> s_TrampolineIndex = 0;
+    static std::atomic<u64> s_TrampolineFailCount = 0;
+
+    void Initialize() {
+       /* Trampoline blocks are mapped on first use. */
+       InitializeInline();
+    }
+
+    //-------------------------------------------------------------------------
+
+    static Result AllocForTrampoline(uint32_t** rx, uint32_t** rw) {
+        static_assert((TrampolineSize * sizeof(uint32_t)) % 8 == 0, "8-byte align");
+
+        /* Claim a slot, this is the only point of contention between threads. */
+        u64 i = s_TrampolineIndex.fetch_add(1, std::memory_order_relaxed);
+
+        if(i >= HookTotalMax) {
+            s_TrampolineFailCount.fetch_add(1, std::memory_order_relaxed);
+            return result::HookTrampolineAllocFail;
+        }
+
+        u64 block = i / HookMax;
+        u64 slot = i % HookMax;
+        s_HookJit.MapBlock(block);
+
+        HookPool* rwptr = (HookPool*)s_HookJit.GetBlockRw(block);
+        HookPool* rxptr = (HookPool*)s_HookJit.GetBlockRo(block);
+        *rw = (*rwptr)[slot];
+        *rx = (*rxptr)[slot];
+
+        return result::Success;
+    }
+
+    TrampolineStats GetTrampolineStats() {
+        return {
+            .m_UsedCount = std::min(s_TrampolineIndex.load(std::memory_order_relaxed), HookTotalMax),
+            .m_Capacity = HookTotalMax,
+            .m_MappedBlockCount = s_HookJit.GetMappedBlockCount(),
+            .m_BlockCount = s_HookJit.GetBlockCount(),
+            .m_FailedCount = s_TrampolineFailCount.load(std::memory_order_relaxed),
+        };
+    }
+
+    //-------------------------------------------------------------------------
+
+    namespace {
+        /* Hook entry branch, at most NOP + LDR + BR + 64-bit literal. */
+        constexpr size_t MaxPatchInstructions = 5;
+        constexpr size_t MaxPendingPatches = 32;
+
+        struct PendingPatch {
+            uintptr_t m_Address;
+            size_t m_Count;
+            std::array<uint32_t, MaxPatchInstructions> m_Data;
+        };
+
+        struct Transaction {
+            bool m_Active;
+            size_t m_PatchCount;
+            std::array<PendingPatch, MaxPendingPatches> m_Patches;
+        };
+
+        constinit Transaction s_Transaction {};
+
+        constexpr size_t MaxHookEntries = 128;
+
+        /* Everything needed to toggle or remove an installed hook. */
+        /* With several hooks chained on one address, m_Callback is the one installed last, which runs first. */
+        struct HookEntry {
+            std::atomic<uintptr_t> m_Address;
+            uintptr_t m_Callback;
+            uintptr_t m_Trampoline;
+            size_t m_Count;
+            size_t m_ListenerCount;
+            bool m_Enabled;
+            std::array<uint32_t, MaxPatchInstructions> m_Original;
+            std::array<uint32_t, MaxPatchInstructions> m_Patch;
+            /* Near hooks whose chain head is out of branch range go through LDR + BR + literal in a trampoline slot. */
+            uint32_t* m_VeneerRw;
+            uintptr_t m_Veneer;
+        };
+
+        constinit std::array<HookEntry, MaxHookEntries> s_HookEntries {};
+        constinit std::atomic<size_t> s_HookEntryCount = 0;
+    }
+
+    static void WritePatch(uintptr_t address, const uint32_t* data, size_t count) {
+        const util::RwPages ctrl(address, count * sizeof(uint32_t));
+        uint32_t* rw = reinterpret_cast<uint32_t*>(ctrl.GetRw());
+
+        if(count == 1)
+            __sync_cmpswap(rw, *rw, data[0]);
+        else
+            std::memcpy(rw, data, count * sizeof(uint32_t));
+        
+        /* Caches are flushed when ctrl is destroyed. */
+    }
+
+    static void ApplyPendingPatches() {
+        auto& patches = s_Transaction.m_Patches;
+        const size_t patchCount = s_Transaction.m_PatchCount;
+
+        /* Sort by address so that patches on neighbouring pages can share one mapping. */
+        std::sort(patches.begin(), patches.begin() + patchCount, [](const PendingPatch& lhs, const PendingPatch& rhs) {
+            return lhs.m_Address < rhs.m_Address;
+        });
+
+        size_t runStart = 0;
+        while(runStart < patchCount) {
+            /* Extend the run while the next patch starts on a page already covered, or on the one right after it. */
+            uintptr_t start = ALIGN_DOWN(patches[runStart].m_Address, PAGE_SIZE);
+            uintptr_t end = patches[runStart].m_Address + patches[runStart].m_Count * sizeof(uint32_t);
+            size_t runEnd = runStart + 1;
+            for(; runEnd < patchCount; runEnd++) {
+                const PendingPatch& patch = patches[runEnd];
+                if(ALIGN_DOWN(patch.m_Address, PAGE_SIZE) > ALIGN_UP(end, PAGE_SIZE))
+                    break;
+
+                end = std::max(end, patch.m_Address + patch.m_Count * sizeof(uint32_t));
             }
-        } context;
-
-        //-------------------------------------------------------------------------
-
-        bool __fix_branch_imm(instruction inprwp, instruction inprxp, instruction outprw, instruction outprx,
-                                    context* ctxp) {
-            constexpr uint32_t mbits = 6u;
-            constexpr uint32_t mask = 0xfc000000u;   // 0b11111100000000000000000000000000
-            constexpr uint32_t rmask = 0x03ffffffu;  // 0b00000011111111111111111111111111
-            constexpr uint32_t op_b = 0x14000000u;   // "b"  ADDR_PCREL26
-            constexpr uint32_t op_bl = 0x94000000u;  // "bl" ADDR_PCREL26
-
-            const uint32_t ins = *(*inprwp);
-            const uint32_t opc = ins & mask;
-            switch (opc) {
-                case op_b:
-                case op_bl: {
-                    intptr_t current_idx = ctxp->get_and_set_current_index(*inprxp, *outprx);
-                    int64_t absolute_addr = reinterpret_cast<int64_t>(*inprxp) +
-                                            (static_cast<int32_t>(ins << mbits) >> (mbits - 2u));  // sign-extended
-                    int64_t new_pc_offset =
-                        static_cast<int64_t>(absolute_addr - reinterpret_cast<int64_t>(*outprx)) >> 2;  // shifted
-                    bool special_fix_type = ctxp->is_in_fixing_range(absolute_addr);
-                    // whether the branch should be converted to absolute jump
-                    if (!special_fix_type && llabs(new_pc_offset) >= (rmask >> 1)) {
-                        bool b_aligned = (reinterpret_cast<uint64_t>(*outprx + 2) & 7u) == 0u;
-                        if (opc == op_b) {
-                            if (b_aligned != true) {
-                                (*outprw)[0] = Aarch64Nop;
-                                ctxp->reset_current_ins(current_idx, ++(*outprx));
-                                ++(*outprw);
-                            }                            // if
-                            (*outprw)[0] = 0x58000051u;  // LDR X17, #0x8
-                            (*outprw)[1] = 0xd61f0220u;  // BR X17
-                            memcpy(*outprw + 2, &absolute_addr, sizeof(absolute_addr));
-                            *outprx += 4;
-                            *outprw += 4;
-                        } else {
-                            if (b_aligned == true) {
-                                (*outprw)[0] = Aarch64Nop;
-                                ctxp->reset_current_ins(current_idx, ++(*outprx));
-                                (*outprw)++;
-                            }                            // if
-                            (*outprw)[0] = 0x58000071u;  // LDR X17, #12
-                            (*outprw)[1] = 0x1000009eu;  // ADR X30, #16
-                            (*outprw)[2] = 0xd61f0220u;  // BR X17
-                            memcpy(*outprw + 3, &absolute_addr, sizeof(absolute_addr));
-                            *outprw += 5;
-                            *outprx += 5;
-                        }  // if
-                    } else {
-                        if (special_fix_type) {
-                            intptr_t ref_idx = ctxp->get_ref_ins_index(absolute_addr);
-                            if (ref_idx <= current_idx) {
-                                new_pc_offset =
-                                    static_cast<int64_t>(ctxp->dat[ref_idx].ins - reinterpret_cast<int64_t>(*outprx)) >> 2;
-                            } else {
-                                ctxp->insert_fix_map(ref_idx, *outprw, *outprx, 0u, rmask);
-                                new_pc_offset = 0;
-                            }  // if
-                        }      // if
-
-                        (*outprw)[0] = opc | (new_pc_offset & ~mask);
-                        ++(*outprw);
-                        ++(*outprx);
-                    }  // if
-
-                    ++(*inprxp);
-                    ++(*inprwp);
-                    return ctxp->process_fix_map(current_idx), true;
+
+            {
+                /* Map the run once, write every patch in it, then flush the whole run once on unmap. */
+                const util::RwPages ctrl(start, end - start);
+                for(size_t i = runStart; i < runEnd; i++) {
+                    const PendingPatch& patch = patches[i];
+                    std::memcpy(reinterpret_cast<void*>(ctrl.GetClaim().RoToRw(patch.m_Address)), patch.m_Data.data(), patch.m_Count * sizeof(uint32_t));
                 }
             }
-            return false;
+
+            runStart = runEnd;
         }
 
-        //-------------------------------------------------------------------------
-
-        bool __fix_cond_comp_test_branch(instruction inprwp, instruction inprxp, instruction outprw, instruction outprx,
-                                                context* ctxp) {
-            constexpr uint32_t lsb = 5u;
-            constexpr uint32_t lmask01 = 0xff00001fu;  // 0b11111111000000000000000000011111
-            constexpr uint32_t mask0 = 0xff000010u;    // 0b11111111000000000000000000010000
-            constexpr uint32_t op_bc = 0x54000000u;    // "b.c"  ADDR_PCREL19
-            constexpr uint32_t mask1 = 0x7f000000u;    // 0b01111111000000000000000000000000
-            constexpr uint32_t op_cbz = 0x34000000u;   // "cbz"  Rt, ADDR_PCREL19
-            constexpr uint32_t op_cbnz = 0x35000000u;  // "cbnz" Rt, ADDR_PCREL19
-            constexpr uint32_t lmask2 = 0xfff8001fu;   // 0b11111111111110000000000000011111
-            constexpr uint32_t mask2 = 0x7f000000u;    // 0b01111111000000000000000000000000
-            constexpr uint32_t op_tbz =
-                0x36000000u;  // 0b00110110000000000000000000000000 "tbz"  Rt, BIT_NUM, ADDR_PCREL14
-            constexpr uint32_t op_tbnz =
-                0x37000000u;  // 0b00110111000000000000000000000000 "tbnz" Rt, BIT_NUM, ADDR_PCREL14
-
-            const uint32_t ins = *(*inprwp);
-            uint32_t lmask = lmask01;
-            if ((ins & mask0) != op_bc) {
-                uint32_t opc = ins & mask1;
-                if (opc != op_cbz && opc != op_cbnz) {
-                    opc = ins & mask2;
-                    if (opc != op_tbz && opc != op_tbnz) {
-                        return false;
-                    }  // if
-                    lmask = lmask2;
-                }  // if
-            }      // if
-
-            intptr_t current_idx = ctxp->get_and_set_current_index(*inprxp, *outprx);
-            int64_t absolute_addr = reinterpret_cast<int64_t>(*inprxp) + ((ins & ~lmask) >> (lsb - 2u));
-            int64_t new_pc_offset = static_cast<int64_t>(absolute_addr - reinterpret_cast<int64_t>(*outprx)) >> 2;  // shifted
-            bool special_fix_type = ctxp->is_in_fixing_range(absolute_addr);
-            if (!special_fix_type && llabs(new_pc_offset) >= (~lmask >> (lsb + 1))) {
-                if ((reinterpret_cast<uint64_t>(*outprx + 4) & 7u) != 0u) {
-                    (*outprw)[0] = Aarch64Nop;
-                    ctxp->reset_current_ins(current_idx, *outprx);
-
-                    (*outprx)++;
-                    (*outprw)++;
-                }                                                               // if
-                (*outprw)[0] = (((8u >> 2u) << lsb) & ~lmask) | (ins & lmask);  // B.C #0x8
-                (*outprw)[1] = 0x14000005u;                                     // B #0x14
-                (*outprw)[2] = 0x58000051u;                                     // LDR X17, #0x8
-                (*outprw)[3] = 0xd61f0220u;                                     // BR X17
-                memcpy(*outprw + 4, &absolute_addr, sizeof(absolute_addr));
-                *outprw += 6;
-                *outprx += 6;
-            } else {
-                if (special_fix_type) {
-                    intptr_t ref_idx = ctxp->get_ref_ins_index(absolute_addr);
-                    if (ref_idx <= current_idx) {
-                        new_pc_offset = static_cast<int64_t>(ctxp->dat[ref_idx].ins - reinterpret_cast<int64_t>(*outprx)) >> 2;
-                    } else {
-                        ctxp->insert_fix_map(ref_idx, *outprw, *outprx, lsb, ~lmask);
-                        new_pc_offset = 0;
-                    }  // if
-                }      // if
-
-                (*outprw)[0] = (static_cast<uint32_t>(new_pc_offset << lsb) & ~lmask) | (ins & lmask);
-                ++(*outprw);
-                ++(*outprx);
-            }  // if
+        s_Transaction.m_PatchCount = 0;
+    }
 
-            ++(*inprxp);
-            ++(*inprwp);
-            return ctxp->process_fix_map(current_idx), true;
+    static void QueuePatch(uintptr_t address, const uint32_t* data, size_t count) {
+        EXL_ASSERT(count <= MaxPatchInstructions);
+
+        /* A hook chained onto one from the same transaction rewrites its patch, only the latest version is written. */
+        PendingPatch* pending = nullptr;
+        for(size_t i = 0; i < s_Transaction.m_PatchCount; i++) {
+            if(s_Transaction.m_Patches[i].m_Address == address) {
+                pending = &s_Transaction.m_Patches[i];
+                break;
+            }
         }
 
-        //-------------------------------------------------------------------------
+        /* Make room by applying what we have so far, this only costs an extra mapping. */
+        if(pending == nullptr && s_Transaction.m_PatchCount == MaxPendingPatches)
+            ApplyPendingPatches();
 
-        bool __fix_loadlit(instruction inprwp, instruction inprxp, instruction outprw, instruction outprx,
-                                context* ctxp) {
-            const uint32_t ins = *(*inprwp);
+        auto& patch = pending != nullptr ? *pending : s_Transaction.m_Patches[s_Transaction.m_PatchCount++];
+        patch.m_Address = address;
+        patch.m_Count = count;
+        std::memcpy(patch.m_Data.data(), data, count * sizeof(uint32_t));
+    }
 
-            // memory prefetch("prfm"), just skip it
-            // http://infocenter.arm.com/help/topic/com.arm.doc.100069_0608_00_en/pge1427897420050.html
-            if ((ins & 0xff000000u) == 0xd8000000u) {
-                ctxp->process_fix_map(ctxp->get_and_set_current_index(*inprxp, *outprx));
-                ++(*inprwp);
-                ++(*inprxp);
-                return true;
-            }  // if
+    void BeginTransaction() {
+        EXL_ASSERT(!s_Transaction.m_Active);
 
-            constexpr uint32_t msb = 8u;
-            constexpr uint32_t lsb = 5u;
-            constexpr uint32_t mask_30 = 0x40000000u;   // 0b01000000000000000000000000000000
-            constexpr uint32_t mask_31 = 0x80000000u;   // 0b10000000000000000000000000000000
-            constexpr uint32_t lmask = 0xff00001fu;     // 0b11111111000000000000000000011111
-            constexpr uint32_t mask_ldr = 0xbf000000u;  // 0b10111111000000000000000000000000
-            constexpr uint32_t op_ldr =
-                0x18000000u;  // 0b00011000000000000000000000000000 "LDR Wt/Xt, label" | ADDR_PCREL19
-            constexpr uint32_t mask_ldrv = 0x3f000000u;  // 0b00111111000000000000000000000000
-            constexpr uint32_t op_ldrv =
-                0x1c000000u;  // 0b00011100000000000000000000000000 "LDR St/Dt/Qt, label" | ADDR_PCREL19
-            constexpr uint32_t mask_ldrsw = 0xff000000u;  // 0b11111111000000000000000000000000
-            constexpr uint32_t op_ldrsw = 0x98000000u;  // "LDRSW Xt, label" | ADDR_PCREL19 | load register signed word
-            // LDR S0, #0 | 0b00011100000000000000000000000000 | 32-bit
-            // LDR D0, #0 | 0b01011100000000000000000000000000 | 64-bit
-            // LDR Q0, #0 | 0b10011100000000000000000000000000 | 128-bit
-            // INVALID    | 0b11011100000000000000000000000000 | may be 256-bit
-
-            uint32_t mask = mask_ldr;
-            uintptr_t faligned = (ins & mask_30) ? 7u : 3u;
-            if ((ins & mask_ldr) != op_ldr) {
-                mask = mask_ldrv;
-                if (faligned != 7u) faligned = (ins & mask_31) ? 15u : 3u;
-                if ((ins & mask_ldrv) != op_ldrv) {
-                    if ((ins & mask_ldrsw) != op_ldrsw) {
-                        return false;
-                    }  // if
-                    mask = mask_ldrsw;
-                    faligned = 7u;
-                }  // if
-            }      // if
-
-            intptr_t current_idx = ctxp->get_and_set_current_index(*inprxp, *outprx);
-            int64_t absolute_addr =
-                reinterpret_cast<int64_t>(*inprxp) + ((static_cast<int32_t>(ins << msb) >> (msb + lsb - 2u)) & ~3u);
-            int64_t new_pc_offset = static_cast<int64_t>(absolute_addr - reinterpret_cast<int64_t>(*outprx)) >> 2;  // shifted
-            bool special_fix_type = ctxp->is_in_fixing_range(absolute_addr);
-            // special_fix_type may encounter issue when there are mixed data and code
-            if (special_fix_type ||
-                (llabs(new_pc_offset) + (faligned + 1u - 4u) / 4u) >= (~lmask >> (lsb + 1))) {  // inaccurate, but it works
-                while ((reinterpret_cast<uint64_t>(*outprx + 2) & faligned) != 0u) {
-                    *(*outprw)++ = Aarch64Nop;
-                    (*outprx)++;
-                }
-                ctxp->reset_current_ins(current_idx, *outprx);
-
-                // Note that if memory at absolute_addr is writeable (non-const), we will fail to fetch it.
-                // And what's worse, we may unexpectedly overwrite something if special_fix_type is true...
-                uint32_t ns = static_cast<uint32_t>((faligned + 1) / sizeof(uint32_t));
-                (*outprw)[0] = (((8u >> 2u) << lsb) & ~mask) | (ins & lmask);  // LDR #0x8
-                (*outprw)[1] = 0x14000001u + ns;                               // B #0xc
-                memcpy(*outprw + 2, reinterpret_cast<void*>(absolute_addr), faligned + 1);
-                *outprw += 2 + ns;
-                *outprx += 2 + ns;
-            } else {
-                faligned >>= 2;  // new_pc_offset is shifted and 4-byte aligned
-                while ((new_pc_offset & faligned) != 0) {
-                    *(*outprw)++ = Aarch64Nop;
-                    (*outprx)++;
-                    new_pc_offset = static_cast<int64_t>(absolute_addr - reinterpret_cast<int64_t>(*outprx)) >> 2;
-                }
-                ctxp->reset_current_ins(current_idx, *outprx);
+        s_Transaction.m_Active = true;
+        s_Transaction.m_PatchCount = 0;
+    }
 
-                (*outprw)[0] = (static_cast<uint32_t>(new_pc_offset << lsb) & ~mask) | (ins & lmask);
-                ++(*outprx);
-                ++(*outprw);
-            }  // if
+    void CommitTransaction() {
+        EXL_ASSERT(s_Transaction.m_Active);
 
-            ++(*inprxp);
-            ++(*inprwp);
-            return ctxp->process_fix_map(current_idx), true;
-        }
+        ApplyPendingPatches();
+        s_Transaction.m_Active = false;
 
-        //-------------------------------------------------------------------------
-
-        bool __fix_pcreladdr(instruction inprwp, instruction inprxp, instruction outprw, instruction outprx,
-                                    context* ctxp) {
-            // Load a PC-relative address into a register
-            // http://infocenter.arm.com/help/topic/com.arm.doc.100069_0608_00_en/pge1427897645644.html
-            constexpr uint32_t msb = 8u;
-            constexpr uint32_t lsb = 5u;
-            constexpr uint32_t mask = 0x9f000000u;     // 0b10011111000000000000000000000000
-            constexpr uint32_t rmask = 0x0000001fu;    // 0b00000000000000000000000000011111
-            constexpr uint32_t lmask = 0xff00001fu;    // 0b11111111000000000000000000011111
-            constexpr uint32_t fmask = 0x00ffffffu;    // 0b00000000111111111111111111111111
-            constexpr uint32_t max_val = 0x001fffffu;  // 0b00000000000111111111111111111111
-            constexpr uint32_t op_adr = 0x10000000u;   // "adr"  Rd, ADDR_PCREL21
-            constexpr uint32_t op_adrp = 0x90000000u;  // "adrp" Rd, ADDR_ADRP
-
-            const uint32_t ins = *(*inprwp);
-            intptr_t current_idx;
-            switch (ins & mask) {
-                case op_adr: {
-                    current_idx = ctxp->get_and_set_current_index(*inprxp, *outprx);
-                    int64_t lsb_bytes = static_cast<uint32_t>(ins << 1u) >> 30u;
-                    int64_t absolute_addr = reinterpret_cast<int64_t>(*inprxp) +
-                                            (((static_cast<int32_t>(ins << msb) >> (msb + lsb - 2u)) & ~3u) | lsb_bytes);
-                    int64_t new_pc_offset = static_cast<int64_t>(absolute_addr - reinterpret_cast<int64_t>(*outprx));
-                    bool special_fix_type = ctxp->is_in_fixing_range(absolute_addr);
-                    if (!special_fix_type && llabs(new_pc_offset) >= (max_val >> 1)) {
-                        if ((reinterpret_cast<uint64_t>(*outprx + 2) & 7u) != 0u) {
-                            (*outprw)[0] = Aarch64Nop;
-                            ctxp->reset_current_ins(current_idx, ++(*outprx));
-                            ++*(outprw);
-                        }  // if
-
-                        (*outprw)[0] = 0x58000000u | (((8u >> 2u) << lsb) & ~mask) | (ins & rmask);  // LDR #0x8
-                        (*outprw)[1] = 0x14000003u;                                                  // B #0xc
-                        memcpy(*outprw + 2, &absolute_addr, sizeof(absolute_addr));
-                        *outprw += 4;
-                        *outprx += 4;
-                    } else {
-                        if (special_fix_type) {
-                            intptr_t ref_idx = ctxp->get_ref_ins_index(absolute_addr & ~3ull);
-                            if (ref_idx <= current_idx) {
-                                new_pc_offset =
-                                    static_cast<int64_t>(ctxp->dat[ref_idx].ins - reinterpret_cast<int64_t>(*outprx));
-                            } else {
-                                ctxp->insert_fix_map(ref_idx, *outprw, *outprx, lsb, fmask);
-                                new_pc_offset = 0;
-                            }  // if
-                        }      // if
-
-                        // the lsb_bytes will never be changed, so we can use lmask to keep it
-                        (*outprw)[0] = (static_cast<uint32_t>(new_pc_offset << (lsb - 2u)) & fmask) | (ins & lmask);
-                        ++(*outprw);
-                        ++(*outprx);
-                    }  // if
-                } break;
-                case op_adrp: {
-                    current_idx = ctxp->get_and_set_current_index(*inprxp, *outprw);
-                    int32_t lsb_bytes = static_cast<uint32_t>(ins << 1u) >> 30u;
-                    int64_t absolute_addr =
-                        (reinterpret_cast<int64_t>(*inprxp) & ~0xfffll) +
-                        ((((static_cast<int32_t>(ins << msb) >> (msb + lsb - 2u)) & ~3u) | lsb_bytes) << 12);
-                    if (ctxp->is_in_fixing_range(absolute_addr)) {
-                        intptr_t ref_idx = ctxp->get_ref_ins_index(absolute_addr /* & ~3ull*/);
-                        if (ref_idx > current_idx) {
-                            // the bottom 12 bits of absolute_addr are masked out,
-                            // so ref_idx must be less than or equal to current_idx!
-                            /*skyline::logger::s_Instance->Log(
-                                "[And64InlineHook] ref_idx must be less than or equal to current_idx!\n");*/
-                        }  // if
-
-                        // *absolute_addr may be changed due to relocation fixing
-                        *(*outprw)++ = ins;  // 0x90000000u;
-                        (*outprx)++;
-                    } else {
-                        if ((reinterpret_cast<uint64_t>(*outprx + 2) & 7u) != 0u) {
-                            (*outprw)[0] = Aarch64Nop;
-                            ctxp->reset_current_ins(current_idx, ++(*outprx));
-                            ++*(outprw);
-                        }  // if
-
-                        (*outprw)[0] = 0x58000000u | (((8u >> 2u) << lsb) & ~mask) | (ins & rmask);  // LDR #0x8
-                        (*outprw)[1] = 0x14000003u;                                                  // B #0xc
-                        memcpy(*outprw + 2, &absolute_addr, sizeof(absolute_addr));                  // potential overflow?
-                        *outprw += 4;
-                        *outprx += 4;
-                    }  // if
-                } break;
-                default:
-                    return false;
-            }
+        /* Trampolines were only written through the JIT's rw mapping, flush them once for every hook installed. */
+        s_HookJit.Flush();
+        FlushInline();
+    }
 
-            ctxp->process_fix_map(current_idx);
-            ++(*inprxp);
-            ++(*inprwp);
-            return true;
-        }
+    bool IsInTransaction() {
+        return s_Transaction.m_Active;
+    }
 
-        #define __flush_cache(c, n) __builtin___clear_cache(reinterpret_cast<char*>(c), reinterpret_cast<char*>(c) + n)
-
-        //-------------------------------------------------------------------------
-
-        void __fix_instructions(uint32_t* __restrict inprw, uint32_t* __restrict inprx, int32_t count,
-                                    uint32_t* __restrict outrwp, uint32_t* __restrict outrxp) {
-            context ctx;
-            ctx.basep = reinterpret_cast<int64_t>(inprx);
-            ctx.endp = reinterpret_cast<int64_t>(inprx + count);
-            memset(ctx.dat, 0, sizeof(ctx.dat));
-            static_assert(sizeof(ctx.dat) / sizeof(ctx.dat[0]) == MaxInstructions, "please use MaxInstructions!");
-        #ifndef NDEBUG
-            if (count > MaxInstructions) {
-                EXL_ABORT(result::HookFixingTooManyInstructions);
-            }   // if
-        #endif  // NDEBUG
-
-            uint32_t* const outprx_base = outrxp;
-            uint32_t* const outprw_base = outrwp;
-
-            while (--count >= 0) {
-                if (__fix_branch_imm(&inprw, &inprx, &outrwp, &outrxp, &ctx)) continue;
-                if (__fix_cond_comp_test_branch(&inprw, &inprx, &outrwp, &outrxp, &ctx)) continue;
-                if (__fix_loadlit(&inprw, &inprx, &outrwp, &outrxp, &ctx)) continue;
-                if (__fix_pcreladdr(&inprw, &inprx, &outrwp, &outrxp, &ctx)) continue;
-
-                // without PC-relative offset
-                ctx.process_fix_map(ctx.get_and_set_current_index(inprx, outrxp));
-                *(outrwp++) = *(inprw++);
-                outrxp++;
-                inprx++;
-            }
+    //-------------------------------------------------------------------------
 
-            constexpr uint_fast64_t mask = 0x03ffffffu;  // 0b00000011111111111111111111111111
-            auto callback = reinterpret_cast<int64_t>(inprx);
-            auto pc_offset = static_cast<int64_t>(callback - reinterpret_cast<int64_t>(outrxp)) >> 2;
-            if (llabs(pc_offset) >= (mask >> 1)) {
-                if ((reinterpret_cast<uint64_t>(outrxp + 2) & 7u) != 0u) {
-                    outrwp[0] = Aarch64Nop;
-                    ++outrxp;
-                    ++outrwp;
-                }                         // if
-                outrwp[0] = 0x58000051u;  // LDR X17, #0x8
-                outrwp[1] = 0xd61f0220u;  // BR X17
-                *reinterpret_cast<int64_t*>(outrwp + 2) = callback;
-                outrwp += 4;
-                outrxp += 4;
-            } else {
-                outrwp[0] = 0x14000000u | (pc_offset & mask);  // "B" ADDR_PCREL26
-                ++outrwp;
-                ++outrxp;
-            }  // if
+    static void RegisterHook(uintptr_t address, uintptr_t callback, uintptr_t trampoline, const uint32_t* patch, size_t count) {
+        size_t index = s_HookEntryCount.fetch_add(1, std::memory_order_relaxed);
+
+        /* A hook missing from the registry can't be toggled, and a later hook on it would patch over it instead of chaining. */
+        if(index >= MaxHookEntries)
+            EXL_ABORT(result::HookRegistryFull);
+
+        HookEntry& entry = s_HookEntries[index];
+        entry.m_Callback = callback;
+        entry.m_Trampoline = trampoline;
+        entry.m_Count = count;
+        entry.m_ListenerCount = 1;
+        entry.m_Enabled = true;
+        entry.m_VeneerRw = nullptr;
+        entry.m_Veneer = 0;
+        std::memcpy(entry.m_Original.data(), reinterpret_cast<const void*>(address), count * sizeof(uint32_t));
+        std::memcpy(entry.m_Patch.data(), patch, count * sizeof(uint32_t));
+
+        /* Publish the entry last so lookups never see it half written. */
+        entry.m_Address.store(address, std::memory_order_release);
+    }
 
-            const uintptr_t total = (outrxp - outprx_base) * sizeof(uint32_t);
-            // __flush_cache(outprx_base, total);  // necessary
-            __flush_cache(outprw_base, total);
+    static HookEntry* FindHook(uintptr_t address) {
+        size_t count = std::min(s_HookEntryCount.load(std::memory_order_relaxed), MaxHookEntries);
+        for(size_t i = 0; i < count; i++) {
+            if(s_HookEntries[i].m_Address.load(std::memory_order_acquire) == address)
+                return &s_HookEntries[i];
         }
+        return nullptr;
     }
 
-    //-------------------------------------------------------------------------
+    /* Far hooks branch through a 64-bit literal placed after LDR + BR. */
+    static uintptr_t GetLiteralAddress(const HookEntry& entry) {
+        return entry.m_Address.load(std::memory_order_relaxed) + (entry.m_Count - 2) * sizeof(uint32_t);
+    }
 
-    //static nn::os::MutexType hookMutex;
+    static void WriteLiteral(uintptr_t address, uintptr_t value) {
+        const util::RwPages ctrl(address, sizeof(uintptr_t));
+        __atomic_store_n(reinterpret_cast<uintptr_t*>(ctrl.GetRw()), value, __ATOMIC_RELEASE);
+    }
 
-    //-------------------------------------------------------------------------
+    static Result SetHookEnabled(uintptr_t address, bool enable) {
+        EXL_ASSERT(!IsInTransaction());
 
-    JIT_CREATE(s_HookJit, setting::JitSize);
+        HookEntry* entry = FindHook(address);
+        if(entry == nullptr)
+            return result::HookNotFound;
 
-    void Initialize() {
-       s_HookJit.Initialize();
-       InitializeInline();
+        if(entry->m_Enabled == enable)
+            return result::Success;
+
+        /* Either way only one instruction or one aligned literal changes, which is atomic for other threads. */
+        if(entry->m_Count == 1) {
+            WritePatch(address, enable ? entry->m_Patch.data() : entry->m_Original.data(), 1);
+        } else {
+            /* Without a trampoline there is nothing to run the original instructions from. */
+            if(entry->m_Trampoline == 0)
+                return result::HookNotToggleable;
+
+            WriteLiteral(GetLiteralAddress(*entry), enable ? entry->m_Callback : entry->m_Trampoline);
+        }
+
+        entry->m_Enabled = enable;
+        return result::Success;
     }
 
-    //-------------------------------------------------------------------------
+    Result EnableHook(uintptr_t hook) {
+        return SetHookEnabled(hook, true);
+    }
 
-    static Result AllocForTrampoline(uint32_t** rx, uint32_t** rw) {
-        static_assert((TrampolineSize * sizeof(uint32_t)) % 8 == 0, "8-byte align");
-        static volatile s32 index = -1;
+    Result DisableHook(uintptr_t hook) {
+        return SetHookEnabled(hook, false);
+    }
 
-        uint32_t i = __atomic_increase(&index);
-        
-        if(i > HookMax)
-            return result::HookTrampolineAllocFail;
+    bool IsHookEnabled(uintptr_t hook) {
+        HookEntry* entry = FindHook(hook);
+        return entry != nullptr && entry->m_Enabled;
+    }
+
+    Result UninstallHook(uintptr_t hook) {
+        EXL_ASSERT(!IsInTransaction());
+
+        HookEntry* entry = FindHook(hook);
+        if(entry == nullptr)
+            return result::HookNotFound;
 
-        HookPool* rwptr = (HookPool*)s_HookJit.GetRw();
-        HookPool* rxptr = (HookPool*)s_HookJit.GetRo();
-        *rw = (*rwptr)[i];
-        *rx = (*rxptr)[i];
+        if(entry->m_Count == 1) {
+            WritePatch(hook, entry->m_Original.data(), 1);
+        } else {
+            /* Route any thread that is about to enter the hook to the trampoline before restoring, */
+            /* restoring several instructions can't be done atomically. */
+            if(entry->m_Enabled && entry->m_Trampoline != 0)
+                WriteLiteral(GetLiteralAddress(*entry), entry->m_Trampoline);
+
+            WritePatch(hook, entry->m_Original.data(), entry->m_Count);
+        }
 
+        /* The trampoline slot is not reclaimed, Orig stays callable. */
+        entry->m_Address.store(0, std::memory_order_release);
         return result::Success;
     }
 
     //-------------------------------------------------------------------------
 
+    static constexpr uint_fast64_t BranchMask = 0x03ffffffu;  // 0b00000011111111111111111111111111
+
+    /* Far branches load their target from the literal that follows them. */
+    static constexpr uint32_t FarBranchLoad = inst::LdrLiteral(reg::X17, 0x8).Value();
+    static constexpr uint32_t FarBranchJump = inst::BranchRegister(reg::X17).Value();
+
+    static void WriteHookPatch(uintptr_t address, const uint32_t* data, size_t count) {
+        if (IsInTransaction())
+            QueuePatch(address, data, count);
+        else
+            WritePatch(address, data, count);
+    }
+
+    static void WriteVeneerLiteral(HookEntry& entry, uintptr_t target) {
+        __atomic_store_n(reinterpret_cast<uintptr_t*>(entry.m_VeneerRw + 2), target, __ATOMIC_RELEASE);
+        armDCacheFlush(entry.m_VeneerRw, 4 * sizeof(uint32_t));
+    }
+
+    /* Makes callback the new head of the hook chain at entry, returning what it should call to continue down the chain. */
+    /* Every listener reaches the next one through its own Orig, so each extra listener costs one indirect call. */
+    static uintptr_t ChainHook(HookEntry& entry, uintptr_t callback) {
+        const uintptr_t address = entry.m_Address.load(std::memory_order_relaxed);
+        const uintptr_t next = entry.m_Callback;
+
+        if (entry.m_Count == 1) {
+            auto pc_offset = static_cast<int64_t>(callback - address) >> 2;
+
+            if (entry.m_VeneerRw == nullptr && llabs(pc_offset) < (BranchMask >> 1)) {
+                entry.m_Patch[0] = inst::Branch(pc_offset << 2).Value();
+            } else {
+                if (entry.m_VeneerRw == nullptr) {
+                    u32* rxveneer;
+                    u32* rwveneer;
+                    R_ABORT_UNLESS(AllocForTrampoline(&rxveneer, &rwveneer));
+
+                    /* Trampoline slots are 8-byte aligned, so the literal is too. */
+                    rwveneer[0] = FarBranchLoad;
+                    rwveneer[1] = FarBranchJump;
+                    entry.m_VeneerRw = rwveneer;
+                    entry.m_Veneer = __uintval(rxveneer);
+                    WriteVeneerLiteral(entry, callback);
+                    armICacheInvalidate(rxveneer, 4 * sizeof(uint32_t));
+
+                    auto veneer_offset = static_cast<int64_t>(entry.m_Veneer - address) >> 2;
+                    if (llabs(veneer_offset) >= (BranchMask >> 1))
+                        EXL_ABORT(exl::result::HookFailed);
+
+                    entry.m_Patch[0] = inst::Branch(veneer_offset << 2).Value();
+                } else {
+                    WriteVeneerLiteral(entry, callback);
+                }
+            }
+
+            if (entry.m_Enabled)
+                WriteHookPatch(address, entry.m_Patch.data(), 1);
+        } else {
+            /* Far hooks already branch through a literal, only the literal changes. */
+            std::memcpy(&entry.m_Patch[entry.m_Count - 2], &callback, sizeof(callback));
+
+            if (entry.m_Enabled) {
+                if (IsInTransaction())
+                    QueuePatch(address, entry.m_Patch.data(), entry.m_Count);
+                else
+                    WriteLiteral(GetLiteralAddress(entry), callback);
+            }
+        }
+
+        entry.m_Callback = callback;
+        entry.m_ListenerCount++;
+        return next;
+    }
+
     static bool HookFuncImpl(void* const symbol, void* const replace, void* const rxtr, void* const rwtr) {
-        static constexpr uint_fast64_t mask = 0x03ffffffu;  // 0b00000011111111111111111111111111
+        static constexpr uint_fast64_t mask = BranchMask;
 
         uint32_t *rxtrampoline = static_cast<uint32_t*>(rxtr), *rwtrampoline = static_cast<uint32_t*>(rwtr),
                 *original = static_cast<uint32_t*>(symbol);
 
+        /* The original instructions are only read here, the hook branch is written by WritePatch/QueuePatch. */
+        std::array<uint32_t, MaxPatchInstructions> patch;
+        size_t patchCount;
+
         static_assert(MaxInstructions >= 5, "please fix MaxInstructions!");
         auto pc_offset = static_cast<int64_t>(__intval(replace) - __intval(symbol)) >> 2;
         if (llabs(pc_offset) >= (mask >> 1)) {
-            const util::RwPages ctrl((uintptr_t)original, 5 * sizeof(uint32_t));
-
             int32_t count = (reinterpret_cast<uint64_t>(original + 2) & 7u) != 0u ? 5 : 4;
 
-            original = (u32*)ctrl.GetRw();
-
             if (rxtrampoline) {
                 if (TrampolineSize < count * 10u) {
                     return false;
                 }  // if
-                __fix_instructions(original, (u32*)ctrl.GetRo(), count, rwtrampoline, rxtrampoline);
+                if (!__fix_instructions(original, original, count, rwtrampoline, rxtrampoline)) {
+                    EXL_ABORT(result::HookFixingTooManyInstructions);
+                }  // if
             }  // if
 
+            uint32_t* out = patch.data();
             if (count == 5) {
-                original[0] = Aarch64Nop;
-                ++original;
-            }                           // if
-            original[0] = 0x58000051u;  // LDR X17, #0x8
-            original[1] = 0xd61f0220u;  // BR X17
-            *reinterpret_cast<int64_t*>(original + 2) = __intval(replace);
-            __flush_cache(symbol, 5 * sizeof(uint32_t));
+                out[0] = inst::Nop().Value();
+                ++out;
+            }  // if
+            out[0] = FarBranchLoad;
+            out[1] = FarBranchJump;
+            int64_t replaceAddress = __intval(replace);
+            std::memcpy(out + 2, &replaceAddress, sizeof(replaceAddress));
+            patchCount = count;
         } else {
-            const util::RwPages ctrl((uintptr_t)original, 1 * sizeof(uint32_t));
-
-            original = (u32*)ctrl.GetRw();
-
             if (rwtrampoline) {
                 if (TrampolineSize < 1u * 10u) {
                     return false;
                 }  // if
-                __fix_instructions(original, (u32*)ctrl.GetRo(), 1, rwtrampoline, rxtrampoline);
+                if (!__fix_instructions(original, original, 1, rwtrampoline, rxtrampoline)) {
+                    EXL_ABORT(result::HookFixingTooManyInstructions);
+                }  // if
             }  // if
 
-            __sync_cmpswap(original, *original, 0x14000000u | (pc_offset & mask));  // "B" ADDR_PCREL26
-            __flush_cache(symbol, 1 * sizeof(uint32_t));
+            patch[0] = inst::Branch(pc_offset << 2).Value();
+            patchCount = 1;
         }  // if
 
+        RegisterHook(__uintval(symbol), __uintval(replace), __uintval(rxtrampoline), patch.data(), patchCount);
+        WriteHookPatch(__uintval(symbol), patch.data(), patchCount);
+
         return true;
     }
 
@@ -609,7 +511,17 @@ namespace exl::hook::nx64 {
         EXL_ASSERT(hook != 0);
         EXL_ASSERT(callback != 0);
 
-        /* TODO: thread safety */
+        /* Trampoline allocation is thread safe, transactions are not and should be used from one thread. */
+
+        /* Relocating an already patched entry would copy our own branch into a second trampoline, chain instead. */
+        /* Chaining, like transactions, should be done from one thread. */
+        if (HookEntry* entry = FindHook(hook); entry != nullptr) {
+            /* A replace hook has no Orig to continue down the chain with, so the hooks already there would never run. */
+            if (!do_trampoline)
+                EXL_ABORT(result::HookChainDropsListener);
+
+            return ChainHook(*entry, callback);
+        }
 
         u32* rxtrampoline = NULL;
         u32* rwtrampoline = NULL;
@@ -619,7 +531,11 @@ namespace exl::hook::nx64 {
         if (!HookFuncImpl(reinterpret_cast<void*>(hook), reinterpret_cast<void*>(callback), rxtrampoline, rwtrampoline))
             EXL_ABORT(exl::result::HookFailed);
 
-        s_HookJit.Flush();
+        /* Only the trampoline we wrote needs flushing. Deferred to commit when batching. */
+        if (rxtrampoline && !IsInTransaction()) {
+            armDCacheFlush(rwtrampoline, TrampolineSize * sizeof(uint32_t));
+            armICacheInvalidate(rxtrampoline, TrampolineSize * sizeof(uint32_t));
+        }
 
         return (uintptr_t) rxtrampoline;
     }
@@ -7,6 +7,36 @@ namespace exl::hook::nx64 {
 
     void Initialize();
 
+    struct TrampolineStats {
+        size_t m_UsedCount;
+        size_t m_Capacity;
+        size_t m_MappedBlockCount;
+        size_t m_BlockCount;
+        size_t m_FailedCount;
+    };
+
+    TrampolineStats GetTrampolineStats();
+
+    /* Hooking an address that is already hooked chains the new callback in front of the existing ones, sharing the */
+    /* first hook's trampoline. Toggling and uninstalling act on the whole chain at that address. */
+    /* Toggling swaps a single instruction, or a single literal for far hooks, so it is safe while other threads run. */
+    /* Uninstalling a far hook restores several instructions and should only be done while nothing can enter it. */
+    Result EnableHook(uintptr_t hook);
+    Result DisableHook(uintptr_t hook);
+    Result UninstallHook(uintptr_t hook);
+    bool IsHookEnabled(uintptr_t hook);
+
+    /* While a transaction is active, hook branches are queued instead of written. */
+    /* Commit maps every touched page once and flushes the caches once. */
+    void BeginTransaction();
+    void CommitTransaction();
+    bool IsInTransaction();
+
     uintptr_t Hook(uintptr_t hook, uintptr_t callback, bool do_trampoline = false);
     void HookInline(uintptr_t hook, uintptr_t callback);
+
+    /* Like HookInline, but the entry only saves the registers in the mask (bit n is Xn) and LR. Caller-saved */
+    /* registers outside the mask may be clobbered by the callback, so every one live at the hook must be included. */
+    /* save_neon additionally preserves the caller-saved vector registers. */
+    void HookInlineMasked(uintptr_t hook, uintptr_t callback, u32 registers, bool save_neon);
 }
\ No newline at end of file
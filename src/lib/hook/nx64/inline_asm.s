@@ -69,4 +69,38 @@ CODE_BEGIN exl_inline_hook_impl
 
     /* Return to entry. */
     ret
-CODE_END
\ No newline at end of file
+CODE_END
+
+/* Used by masked inline hook entries, which store the general purpose registers themselves. */
+/* The caller-saved vector registers go right after the 0x100 bytes of general purpose registers. */
+CODE_BEGIN exl_inline_hook_save_neon
+    stp q0, q1, [sp, #0x100]
+    stp q2, q3, [sp, #0x120]
+    stp q4, q5, [sp, #0x140]
+    stp q6, q7, [sp, #0x160]
+    stp q16, q17, [sp, #0x180]
+    stp q18, q19, [sp, #0x1A0]
+    stp q20, q21, [sp, #0x1C0]
+    stp q22, q23, [sp, #0x1E0]
+    stp q24, q25, [sp, #0x200]
+    stp q26, q27, [sp, #0x220]
+    stp q28, q29, [sp, #0x240]
+    stp q30, q31, [sp, #0x260]
+    ret
+CODE_END
+
+CODE_BEGIN exl_inline_hook_restore_neon
+    ldp q0, q1, [sp, #0x100]
+    ldp q2, q3, [sp, #0x120]
+    ldp q4, q5, [sp, #0x140]
+    ldp q6, q7, [sp, #0x160]
+    ldp q16, q17, [sp, #0x180]
+    ldp q18, q19, [sp, #0x1A0]
+    ldp q20, q21, [sp, #0x1C0]
+    ldp q22, q23, [sp, #0x1E0]
+    ldp q24, q25, [sp, #0x200]
+    ldp q26, q27, [sp, #0x220]
+    ldp q28, q29, [sp, #0x240]
+    ldp q30, q31, [sp, #0x260]
+    ret
+CODE_END
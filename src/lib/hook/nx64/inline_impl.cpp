@@ -2,6 +2,7 @@
 #include <common.hpp>
 
 #include <array>
+#include <bit>
 #include <lib.hpp>
 
 #include "impl.hpp"
@@ -16,40 +17,52 @@ namespace exl::hook::nx64 {
         uintptr_t m_Callback;
     };
 
-    static constexpr size_t InlinePoolCount = setting::InlinePoolSize / sizeof(Entry);
+    /* Masked entries save their registers in the same layout as InlineCtx, vector registers go after it. */
+    static constexpr size_t GprFrameSize = 0x100;
+    static constexpr size_t NeonFrameSize = 24 * 0x10;
+    static_assert(sizeof(InlineCtx) <= GprFrameSize, "");
+
+    /* Every entry starts 8-byte aligned so that literals in them are naturally aligned. */
+    static constexpr size_t EntryAlignment = alignof(Entry);
 
     JIT_CREATE(s_InlineHookJit, setting::InlinePoolSize);
-    static size_t s_EntryIndex = 0;
+    static size_t s_PoolOffset = 0;
 
     extern "C" {
         extern char exl_inline_hook_impl;
+        extern char exl_inline_hook_save_neon;
+        extern char exl_inline_hook_restore_neon;
     }
 
     static uintptr_t GetImpl() {
         return reinterpret_cast<uintptr_t>(&exl_inline_hook_impl);
     }
 
-    static const Entry* GetEntryRx() {
-        return reinterpret_cast<const Entry*>(s_InlineHookJit.GetRo());
-    }
+    static void AllocFromPool(size_t size, uintptr_t* rx, uintptr_t* rw) {
+        /* Ensure enough space in the pool. */
+        size_t offset = ALIGN_UP(s_PoolOffset, EntryAlignment);
+        if(offset + size > setting::InlinePoolSize)
+            EXL_ABORT(result::HookTrampolineAllocFail);
 
-    static Entry* GetEntryRw() {
-        return reinterpret_cast<Entry*>(s_InlineHookJit.GetRw());
+        s_PoolOffset = offset + size;
+        *rx = s_InlineHookJit.GetRo() + offset;
+        *rw = s_InlineHookJit.GetRw() + offset;
     }
 
     void InitializeInline() {
         s_InlineHookJit.Initialize();
     }
 
-    void HookInline(uintptr_t hook, uintptr_t callback) {
-        /* Ensure enough space in the pool. */
-        if(s_EntryIndex >= InlinePoolCount)
-            EXL_ABORT(result::HookTrampolineAllocFail);
+    void FlushInline() {
+        s_InlineHookJit.Flush();
+    }
 
+    void HookInline(uintptr_t hook, uintptr_t callback) {
         /* Grab entry from pool. */
-        auto entryRx = &GetEntryRx()[s_EntryIndex];
-        auto entryRw = &GetEntryRw()[s_EntryIndex];
-        s_EntryIndex++;
+        uintptr_t rx, rw;
+        AllocFromPool(sizeof(Entry), &rx, &rw);
+        auto entryRx = reinterpret_cast<const Entry*>(rx);
+        auto entryRw = reinterpret_cast<Entry*>(rw);
 
         /* Get pointer to entry's entrypoint. */
         uintptr_t entryCb = reinterpret_cast<uintptr_t>(&entryRx->m_CbEntry);
@@ -71,7 +84,68 @@ namespace exl::hook::nx64 {
         /* Assign callback to be called to be used by impl. */
         entryRw->m_Callback = callback;
 
-        /* Finally, flush caches to have RX region to be consistent. */
-        s_InlineHookJit.Flush();
+        /* Finally, flush caches to have RX region to be consistent. Deferred to commit when batching. */
+        if(!IsInTransaction())
+            s_InlineHookJit.Flush();
+    }
+
+    void HookInlineMasked(uintptr_t hook, uintptr_t callback, u32 registers, bool save_neon) {
+        /* LR is always saved, the entry needs it to call the callback. */
+        registers &= ~(1u << reg::LR.Index());
+        EXL_ASSERT((registers >> reg::LR.Index()) == 0);
+
+        const size_t frameSize = GprFrameSize + (save_neon ? NeonFrameSize : 0);
+        const size_t registerCount = std::popcount(registers);
+
+        /* sub sp, str lr, stores, [save neon], mov x0, bl, [restore neon], loads, ldr lr, add sp, b */
+        const size_t instCount = 7 + registerCount * 2 + (save_neon ? 2 : 0);
+
+        uintptr_t entryRx, entryRw;
+        AllocFromPool(instCount * sizeof(inst::Instruction), &entryRx, &entryRw);
+
+        /* Hook to call into the entry. */
+        auto trampoline = Hook(hook, entryRx, true);
+
+        auto out = reinterpret_cast<inst::Instruction*>(entryRw);
+        size_t index = 0;
+        auto emit = [&](inst::Instruction instruction) {
+            out[index++] = instruction;
+        };
+        auto pc = [&]() {
+            return entryRx + index * sizeof(inst::Instruction);
+        };
+
+        /* Registers are stored at the same offsets as in InlineCtx, so Xn in the context is Xn. */
+        emit(inst::SubImmediate(reg::SP, reg::SP, frameSize));
+        emit(inst::StrRegisterImmediate(reg::LR, reg::SP, reg::LR.Index()));
+        for(u32 remaining = registers; remaining != 0; remaining &= remaining - 1) {
+            uchar i = std::countr_zero(remaining);
+            emit(inst::StrRegisterImmediate(reg::Register(reg::RegisterKind::X, i), reg::SP, i));
+        }
+
+        if(save_neon)
+            emit(inst::BranchLink(reinterpret_cast<uintptr_t>(&exl_inline_hook_save_neon) - pc()));
+
+        emit(inst::AddImmediate(reg::X0, reg::SP, 0));
+        emit(inst::BranchLink(callback - pc()));
+
+        if(save_neon)
+            emit(inst::BranchLink(reinterpret_cast<uintptr_t>(&exl_inline_hook_restore_neon) - pc()));
+
+        for(u32 remaining = registers; remaining != 0; remaining &= remaining - 1) {
+            uchar i = std::countr_zero(remaining);
+            emit(inst::LdrRegisterImmediate(reg::Register(reg::RegisterKind::X, i), reg::SP, i));
+        }
+        emit(inst::LdrRegisterImmediate(reg::LR, reg::SP, reg::LR.Index()));
+        emit(inst::AddImmediate(reg::SP, reg::SP, frameSize));
+
+        /* Continue into the original code. */
+        emit(inst::Branch(trampoline - pc()));
+
+        EXL_ASSERT(index == instCount);
+
+        /* Finally, flush caches to have RX region to be consistent. Deferred to commit when batching. */
+        if(!IsInTransaction())
+            s_InlineHookJit.Flush();
     }
-}
\ No newline at end of file
+}
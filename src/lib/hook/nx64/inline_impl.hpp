@@ -49,4 +49,5 @@ namespace exl::hook::nx64 {
     };
 
     void InitializeInline();
+    void FlushInline();
 }
\ No newline at end of file
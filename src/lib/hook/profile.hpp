@@ -0,0 +1,170 @@
+#pragma once
+
+#include <common.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <span>
+
+namespace exl::hook {
+
+    /* Reads the virtual counter, this is the same clock nn::os::GetSystemTick uses. */
+    ALWAYS_INLINE u64 ReadCounter() {
+        u64 value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+    }
+
+    ALWAYS_INLINE u64 GetCounterFrequency() {
+        u64 value;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(value));
+        return value;
+    }
+
+    /* Lock-free call statistics for one hook. Bucket n of the histogram counts calls that took [2^(n-1), 2^n) ticks.
+       Per call figures include the original function, the self totals leave out the time spent in it. */
+    class HookProfile {
+        public:
+        static constexpr size_t HistogramBucketCount = 20;
+
+        private:
+        const char* m_Name;
+        std::atomic<u64> m_Count = 0;
+        std::atomic<u64> m_TotalTicks = 0;
+        std::atomic<u64> m_OrigTicks = 0;
+        std::atomic<u64> m_MinTicks = std::numeric_limits<u64>::max();
+        std::atomic<u64> m_MaxTicks = 0;
+        std::array<std::atomic<u64>, HistogramBucketCount> m_Histogram {};
+        std::atomic<bool> m_Registered = false;
+
+        static constexpr size_t GetBucket(u64 ticks) {
+            if(ticks == 0)
+                return 0;
+
+            return std::min<size_t>(64 - __builtin_clzll(ticks), HistogramBucketCount - 1);
+        }
+
+        public:
+        constexpr HookProfile(const char* name) : m_Name(name) {}
+
+        void Record(u64 ticks) {
+            m_Count.fetch_add(1, std::memory_order_relaxed);
+            m_TotalTicks.fetch_add(ticks, std::memory_order_relaxed);
+            m_Histogram[GetBucket(ticks)].fetch_add(1, std::memory_order_relaxed);
+
+            u64 min = m_MinTicks.load(std::memory_order_relaxed);
+            while(ticks < min && !m_MinTicks.compare_exchange_weak(min, ticks, std::memory_order_relaxed));
+
+            u64 max = m_MaxTicks.load(std::memory_order_relaxed);
+            while(ticks > max && !m_MaxTicks.compare_exchange_weak(max, ticks, std::memory_order_relaxed));
+        }
+
+        /* Time a callback spent calling the original function, taken out of the self totals. */
+        void RecordOrig(u64 ticks) {
+            m_OrigTicks.fetch_add(ticks, std::memory_order_relaxed);
+        }
+
+        /* Not synchronized with Record, calls in flight may be counted in the old or the new window. */
+        void Reset() {
+            m_Count.store(0, std::memory_order_relaxed);
+            m_TotalTicks.store(0, std::memory_order_relaxed);
+            m_OrigTicks.store(0, std::memory_order_relaxed);
+            m_MinTicks.store(std::numeric_limits<u64>::max(), std::memory_order_relaxed);
+            m_MaxTicks.store(0, std::memory_order_relaxed);
+            for(auto& bucket : m_Histogram)
+                bucket.store(0, std::memory_order_relaxed);
+        }
+
+        /* Returns false if the profile was already registered. */
+        bool MarkRegistered() {
+            return !m_Registered.exchange(true, std::memory_order_relaxed);
+        }
+
+        inline const char* GetName() const { return m_Name; }
+        inline u64 GetCount() const { return m_Count.load(std::memory_order_relaxed); }
+        inline u64 GetTotalTicks() const { return m_TotalTicks.load(std::memory_order_relaxed); }
+        inline u64 GetSelfTicks() const {
+            /* A call in flight may have recorded its original function but not itself yet. */
+            u64 total = GetTotalTicks();
+            u64 orig = m_OrigTicks.load(std::memory_order_relaxed);
+            return total > orig ? total - orig : 0;
+        }
+        inline u64 GetMaxTicks() const { return m_MaxTicks.load(std::memory_order_relaxed); }
+        inline u64 GetMinTicks() const {
+            u64 min = m_MinTicks.load(std::memory_order_relaxed);
+            return min == std::numeric_limits<u64>::max() ? 0 : min;
+        }
+        inline u64 GetAverageTicks() const {
+            u64 count = GetCount();
+            return count == 0 ? 0 : GetTotalTicks() / count;
+        }
+        inline u64 GetAverageSelfTicks() const {
+            u64 count = GetCount();
+            return count == 0 ? 0 : GetSelfTicks() / count;
+        }
+        inline u64 GetHistogramBucket(size_t index) const { return m_Histogram[index].load(std::memory_order_relaxed); }
+    };
+
+    /* Records the time from construction to destruction into a profile. */
+    class ProfileScope {
+        NON_COPYABLE(ProfileScope);
+        NON_MOVEABLE(ProfileScope);
+
+        HookProfile& m_Profile;
+        u64 m_Start;
+
+        public:
+        ALWAYS_INLINE ProfileScope(HookProfile& profile) : m_Profile(profile), m_Start(ReadCounter()) {}
+        ALWAYS_INLINE ~ProfileScope() { m_Profile.Record(ReadCounter() - m_Start); }
+    };
+
+    /* Records the time from construction to destruction as spent in the original function. */
+    class OrigProfileScope {
+        NON_COPYABLE(OrigProfileScope);
+        NON_MOVEABLE(OrigProfileScope);
+
+        HookProfile& m_Profile;
+        u64 m_Start;
+
+        public:
+        ALWAYS_INLINE OrigProfileScope(HookProfile& profile) : m_Profile(profile), m_Start(ReadCounter()) {}
+        ALWAYS_INLINE ~OrigProfileScope() { m_Profile.RecordOrig(ReadCounter() - m_Start); }
+    };
+
+    namespace impl {
+        constexpr size_t MaxProfiles = 64;
+
+        struct ProfileRegistry {
+            std::array<HookProfile*, MaxProfiles> m_Profiles {};
+            std::atomic<size_t> m_Count = 0;
+        };
+
+        inline ProfileRegistry& GetProfileRegistry() {
+            static constinit ProfileRegistry s_Registry {};
+            return s_Registry;
+        }
+    }
+
+    /* Makes a profile visible through GetProfiles. Registering the same profile twice is a no-op. */
+    inline void RegisterProfile(HookProfile& profile) {
+        if(!profile.MarkRegistered())
+            return;
+
+        auto& registry = impl::GetProfileRegistry();
+        size_t index = registry.m_Count.load(std::memory_order_relaxed);
+        do {
+            if(index >= impl::MaxProfiles)
+                return;
+        } while(!registry.m_Count.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+
+        /* Readers may briefly see a null entry while it is being filled in. */
+        __atomic_store_n(&registry.m_Profiles[index], &profile, __ATOMIC_RELEASE);
+    }
+
+    inline std::span<HookProfile* const> GetProfiles() {
+        auto& registry = impl::GetProfileRegistry();
+        return std::span(registry.m_Profiles.data(), registry.m_Count.load(std::memory_order_acquire));
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "trampoline.hpp"
+#include "profile.hpp"
+
+#include <algorithm>
+
+#define HOOK_DEFINE_PROFILED_TRAMPOLINE(name)                        \
+struct name : public ::exl::hook::impl::ProfiledTrampolineHook<name, #name>
+
+namespace exl::hook::impl {
+
+    /* Lets a string literal be used as a template argument. */
+    template<size_t N>
+    struct ProfileName {
+        char m_Value[N];
+
+        constexpr ProfileName(const char (&str)[N]) {
+            std::copy_n(str, N, m_Value);
+        }
+    };
+
+    template<typename Derived, typename Func>
+    struct ProfiledCallback;
+
+    template<typename Derived, typename R, typename... A>
+    struct ProfiledCallback<Derived, R(*)(A...)> {
+        static R Invoke(A... args) {
+            ProfileScope scope(Derived::GetProfile());
+            return Derived::Callback(std::forward<A>(args)...);
+        }
+    };
+
+    /* Trampoline hook whose callback is timed on every call. Orig is timed separately, so the profile can tell the
+       hook's own cost apart from the function it wraps. */
+    template<typename Derived, ProfileName Name>
+    class ProfiledTrampolineHook : public TrampolineHook<Derived> {
+        friend class TrampolineHook<Derived>;
+
+        using Base = TrampolineHook<Derived>;
+
+        static ALWAYS_INLINE auto GetInstallCallback() {
+            RegisterProfile(GetProfile());
+
+            return &ProfiledCallback<Derived, typename Base::template CallbackFuncPtr<>>::Invoke;
+        }
+
+        public:
+        /* Hides TrampolineHook::Orig for the callback. */
+        template<typename... Args>
+        static ALWAYS_INLINE decltype(auto) Orig(Args &&... args) {
+            OrigProfileScope scope(GetProfile());
+            return Base::Orig(std::forward<Args>(args)...);
+        }
+
+        static ALWAYS_INLINE HookProfile& GetProfile() {
+            static constinit HookProfile s_Profile(Name.m_Value);
+
+            return s_Profile;
+        }
+    };
+
+}
@@ -3,6 +3,7 @@
 #include "base.hpp"
 #include "ro.h"
 #include "util/func_ptrs.hpp"
+#include "util/sys/symbol_cache.hpp"
 
 #define HOOK_DEFINE_REPLACE(name)                        \
 struct name : public ::exl::hook::impl::ReplaceHook<name>
@@ -15,10 +16,23 @@ namespace exl::hook::impl {
         template<typename T = Derived>
         using CallbackFuncPtr = decltype(&T::Callback);
 
+        static ALWAYS_INLINE auto& AddressRef() {
+            static constinit uintptr_t s_Address = 0;
+
+            return s_Address;
+        }
+
+        template<typename InFunc>
+        static ALWAYS_INLINE void InstallImpl(InFunc target) {
+            std::memcpy(&AddressRef(), &target, sizeof(uintptr_t));
+
+            hook::Hook(target, Derived::Callback);
+        }
+
         static ALWAYS_INLINE void InstallAtOffset(ptrdiff_t address) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
-            hook::Hook(util::modules::GetTargetStart() + address, Derived::Callback);
+            InstallImpl(util::modules::GetTargetStart() + address);
         }
 
         template<typename R, typename ...A>
@@ -28,22 +42,39 @@ namespace exl::hook::impl {
             using ArgFuncPtr = decltype(ptr);
             static_assert(std::is_same_v<ArgFuncPtr, CallbackFuncPtr<>>, "Argument pointer type must match callback type!");
 
-            hook::Hook(ptr, Derived::Callback);
+            InstallImpl(ptr);
         }
 
         static ALWAYS_INLINE void InstallAtPtr(uintptr_t ptr) {
             _HOOK_STATIC_CALLBACK_ASSERT();
             
-            hook::Hook(ptr, Derived::Callback);
+            InstallImpl(ptr);
         }
 
         static ALWAYS_INLINE void InstallAtSymbol(const char *sym) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
             uintptr_t address = 0;
-            R_ABORT_UNLESS(nn::ro::LookupSymbol(&address, sym));
+            R_ABORT_UNLESS(util::symbol_cache::Lookup(&address, sym));
+
+            InstallImpl(address);
+        }
+
+        /* Replace hooks have no trampoline, so far hooks can only be uninstalled, not disabled. */
+        static ALWAYS_INLINE Result Enable() {
+            return hook::EnableHook(AddressRef());
+        }
+
+        static ALWAYS_INLINE Result Disable() {
+            return hook::DisableHook(AddressRef());
+        }
+
+        static ALWAYS_INLINE Result Uninstall() {
+            return hook::UninstallHook(AddressRef());
+        }
 
-            hook::Hook(address, Derived::Callback);
+        static ALWAYS_INLINE bool IsEnabled() {
+            return hook::IsHookEnabled(AddressRef());
         }
     };
 
@@ -3,6 +3,7 @@
 #include "base.hpp"
 #include "ro.h"
 #include "util/func_ptrs.hpp"
+#include "util/sys/symbol_cache.hpp"
 #include <functional>
 
 #define HOOK_DEFINE_TRAMPOLINE(name)                        \
@@ -12,7 +13,7 @@ namespace exl::hook::impl {
 
     template<typename Derived>
     class TrampolineHook {
-            
+        protected:
         template<typename T = Derived>
         using CallbackFuncPtr = decltype(&T::Callback);
 
@@ -24,6 +25,24 @@ namespace exl::hook::impl {
             return s_FnPtr;
         }
 
+        static ALWAYS_INLINE auto& AddressRef() {
+            static constinit uintptr_t s_Address = 0;
+
+            return s_Address;
+        }
+
+        template<typename InFunc>
+        static ALWAYS_INLINE void InstallImpl(InFunc target) {
+            std::memcpy(&AddressRef(), &target, sizeof(uintptr_t));
+
+            OrigRef() = hook::Hook(target, Derived::GetInstallCallback(), true);
+        }
+
+        /* What actually gets installed, variants may wrap the callback. */
+        static ALWAYS_INLINE auto GetInstallCallback() {
+            return Derived::Callback;
+        }
+
         public:
         template<typename... Args>
         static ALWAYS_INLINE decltype(auto) Orig(Args &&... args) {
@@ -35,7 +54,7 @@ namespace exl::hook::impl {
         static ALWAYS_INLINE void InstallAtOffset(ptrdiff_t address) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
-            OrigRef() = hook::Hook(util::modules::GetTargetStart() + address, Derived::Callback, true);
+            InstallImpl(util::modules::GetTargetStart() + address);
         }
 
         template<typename R, typename ...A>
@@ -45,22 +64,38 @@ namespace exl::hook::impl {
 
             static_assert(std::is_same_v<ArgFuncPtr, CallbackFuncPtr<>>, "Argument pointer type must match callback type!");
 
-            OrigRef() = hook::Hook(ptr, Derived::Callback, true);
+            InstallImpl(ptr);
         }
 
         static ALWAYS_INLINE void InstallAtPtr(uintptr_t ptr) {
             _HOOK_STATIC_CALLBACK_ASSERT();
             
-            OrigRef() = hook::Hook(ptr, Derived::Callback, true);
+            InstallImpl(ptr);
         }
 
         static ALWAYS_INLINE void InstallAtSymbol(const char *sym) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
             uintptr_t address = 0;
-            R_ABORT_UNLESS(nn::ro::LookupSymbol(&address, sym));
+            R_ABORT_UNLESS(util::symbol_cache::Lookup(&address, sym));
+
+            InstallImpl(address);
+        }
+
+        static ALWAYS_INLINE Result Enable() {
+            return hook::EnableHook(AddressRef());
+        }
+
+        static ALWAYS_INLINE Result Disable() {
+            return hook::DisableHook(AddressRef());
+        }
+
+        static ALWAYS_INLINE Result Uninstall() {
+            return hook::UninstallHook(AddressRef());
+        }
 
-            OrigRef() = hook::Hook(address, Derived::Callback, true);
+        static ALWAYS_INLINE bool IsEnabled() {
+            return hook::IsHookEnabled(AddressRef());
         }
     };
 
@@ -1,6 +1,7 @@
 #include "common.hpp"
 
 #include "program/setting.hpp"
+#include "lib/heap/heap.hpp"
 
 extern "C" {
     /* These magic symbols are provided by the linker.  */
@@ -16,14 +17,11 @@ extern "C" {
 
     #ifdef EXL_USE_FAKEHEAP
 
-    char __fake_heap[exl::setting::HeapSize];
+    alignas(PAGE_SIZE) char __fake_heap[exl::setting::HeapSize];
 
     void __init_heap() {
-        extern char * fake_heap_start;
-        extern char * fake_heap_end;
-
-        fake_heap_start = __fake_heap;
-        fake_heap_end   = __fake_heap + exl::setting::HeapSize;
+        /* malloc and friends are replaced by exl::heap, see lib/heap/malloc.cpp. */
+        exl::heap::impl::InitHeap(__fake_heap, exl::setting::HeapSize);
     }
     
     #endif
@@ -0,0 +1,152 @@
+#include <lib.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace exl::patch {
+
+    namespace {
+        /* Enough for a few sets at once, more ranges are flushed in several rounds. */
+        constexpr size_t MaxFlushRanges = 64;
+
+        /* Does one cache maintenance call per run of ranges that touch each other. */
+        void FlushRanges(util::Range* ranges, size_t count) {
+            if(count == 0)
+                return;
+
+            std::sort(ranges, ranges + count, [](const util::Range& lhs, const util::Range& rhs) {
+                return lhs.m_Start < rhs.m_Start;
+            });
+
+            const auto& pages = impl::GetRwPages();
+            auto flush = [&](const util::Range& range) {
+                armDCacheFlush(reinterpret_cast<void*>(pages.GetRw() + range.m_Start), range.m_Size);
+                armICacheInvalidate(reinterpret_cast<void*>(pages.GetRo() + range.m_Start), range.m_Size);
+            };
+
+            util::Range run = ranges[0];
+            for(size_t i = 1; i < count; i++) {
+                if(ranges[i].m_Start <= run.GetEnd()) {
+                    run.m_Size = std::max(run.GetEnd(), ranges[i].GetEnd()) - run.m_Start;
+                    continue;
+                }
+
+                flush(run);
+                run = ranges[i];
+            }
+            flush(run);
+        }
+    }
+
+    void PatchSet::Add(uintptr_t offset, const void* data, size_t size) {
+        /* Changing the contents while applied would leave the old version in memory with no way to revert it. */
+        EXL_ASSERT(!m_Applied);
+
+        /* Entries are sorted, find where this one goes. */
+        size_t index = 0;
+        for(; index < m_Count; index++) {
+            Entry& entry = m_Entries[index];
+            if(offset + size <= entry.m_Offset)
+                break;
+            if(entry.m_Offset + entry.m_Size <= offset)
+                continue;
+
+            if(entry.m_Offset != offset || entry.m_Size != size)
+                EXL_ABORT(result::PatchOverlap);
+
+            std::memcpy(&m_Patched[entry.m_DataOffset], data, size);
+            return;
+        }
+
+        if(m_Count == MaxPatches || MaxBytes - m_DataSize < size)
+            EXL_ABORT(result::PatchSetFull);
+
+        const auto& pages = impl::GetRwPages();
+
+        std::move_backward(m_Entries.begin() + index, m_Entries.begin() + m_Count, m_Entries.begin() + m_Count + 1);
+        m_Count++;
+
+        Entry& entry = m_Entries[index];
+        entry.m_Offset = offset;
+        entry.m_DataOffset = m_DataSize;
+        entry.m_Size = size;
+        m_DataSize += size;
+
+        std::memcpy(&m_Patched[entry.m_DataOffset], data, size);
+        std::memcpy(&m_Original[entry.m_DataOffset], reinterpret_cast<const void*>(pages.GetRo() + offset), size);
+    }
+
+    void PatchSet::Expect(uintptr_t offset, armv8::InstPattern pattern) {
+        /* Only the first failure is kept. */
+        if(R_FAILED(m_Result))
+            return;
+
+        auto inst = *reinterpret_cast<const armv8::InstType*>(impl::GetRwPages().GetRo() + offset);
+        if(!pattern.Matches(inst)) {
+            m_Result = result::PatchExpectationFailed;
+            m_FailedOffset = offset;
+            m_FailedInst = inst;
+        }
+    }
+
+    size_t PatchSet::Write(bool patched, util::Range* out_ranges, size_t max_ranges) {
+        const auto& pages = impl::GetRwPages();
+        const auto& source = patched ? m_Patched : m_Original;
+
+        size_t count = 0;
+        for(size_t i = 0; i < m_Count; i++) {
+            const Entry& entry = m_Entries[i];
+            std::memcpy(reinterpret_cast<void*>(pages.GetRw() + entry.m_Offset), &source[entry.m_DataOffset], entry.m_Size);
+
+            /* Flush early if there is no room left, this only costs extra cache maintenance calls. */
+            if(count == max_ranges) {
+                FlushRanges(out_ranges, count);
+                count = 0;
+            }
+            out_ranges[count++] = { entry.m_Offset, entry.m_Size };
+        }
+        return count;
+    }
+
+    Result PatchSet::Apply() {
+        PatchSet* self = this;
+        return ApplyAll(std::span(&self, 1));
+    }
+
+    void PatchSet::Revert() {
+        if(!m_Applied)
+            return;
+
+        std::array<util::Range, MaxPatches> ranges;
+        FlushRanges(ranges.data(), Write(false, ranges.data(), ranges.size()));
+        m_Applied = false;
+    }
+
+    Result PatchSet::ApplyAll(std::span<PatchSet* const> sets) {
+        Result result = result::Success;
+
+        std::array<util::Range, MaxFlushRanges> ranges;
+        size_t count = 0;
+        for(PatchSet* set : sets) {
+            if(R_FAILED(set->m_Result)) {
+                if(R_SUCCEEDED(result))
+                    result = set->m_Result;
+                continue;
+            }
+            if(set->m_Applied)
+                continue;
+
+            /* Make sure a whole set fits, or flush what we have so far. */
+            if(ranges.size() - count < set->m_Count) {
+                FlushRanges(ranges.data(), count);
+                count = 0;
+            }
+
+            count += set->Write(true, ranges.data() + count, ranges.size() - count);
+            set->m_Applied = true;
+        }
+
+        FlushRanges(ranges.data(), count);
+        return result;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <common.hpp>
+#include <lib/armv8.hpp>
+#include <lib/util/sys/mem_layout.hpp>
+#include "patch_table.hpp"
+
+#include <array>
+#include <span>
+
+namespace exl::patch {
+
+    /* A group of patches that can be applied and reverted as a whole at any time. The original bytes are snapshotted
+       when a patch is added, so a set should be built before anything else writes over the same code.
+       Patches are kept sorted by address and each toggle does one cache maintenance call per contiguous run of them.
+       Patches are written one at a time, a thread running through a multi instruction patch while it is toggled may
+       see a mix of old and new code. */
+    class PatchSet {
+        NON_COPYABLE(PatchSet);
+        NON_MOVEABLE(PatchSet);
+
+        public:
+        static constexpr size_t MaxPatches = 16;
+        static constexpr size_t MaxBytes = 0x100;
+
+        private:
+        struct Entry {
+            uintptr_t m_Offset;
+            u16 m_DataOffset;
+            u16 m_Size;
+        };
+
+        const char* m_Name;
+        std::array<Entry, MaxPatches> m_Entries {};
+        size_t m_Count = 0;
+        std::array<u8, MaxBytes> m_Patched {};
+        std::array<u8, MaxBytes> m_Original {};
+        size_t m_DataSize = 0;
+        bool m_Applied = false;
+        Result m_Result = result::Success;
+        uintptr_t m_FailedOffset = 0;
+        armv8::InstType m_FailedInst = 0;
+
+        /* Writes the set without any cache maintenance, adding the ranges written to out_ranges. */
+        size_t Write(bool patched, util::Range* out_ranges, size_t max_ranges);
+
+        public:
+        constexpr PatchSet(const char* name) : m_Name(name) {}
+
+        /* A patch over the exact range of an earlier one replaces it, any other overlap aborts. */
+        void Add(uintptr_t offset, const void* data, size_t size);
+
+        inline void AddInst(uintptr_t offset, armv8::InstBitSet inst) {
+            armv8::InstType value = inst.Value();
+            Add(offset, &value, sizeof(value));
+        }
+
+        inline void AddSequence(uintptr_t offset, const InstSequence& sequence) {
+            Add(offset, sequence.m_Insts.data(), sequence.GetSize());
+        }
+
+        void AddTable(std::span<const TableEntry> table) {
+            for(const auto& entry : table) {
+                if(entry.m_Expect.m_Mask != 0)
+                    Expect(entry.m_Offset, entry.m_Expect);
+                AddSequence(entry.m_Offset, entry.m_Code);
+            }
+        }
+
+        /* Checked right away against the code as it is now. A set with a failed expectation never applies. */
+        void Expect(uintptr_t offset, armv8::InstPattern pattern);
+
+        inline void Expect(uintptr_t offset, armv8::decode::InstKind kind) {
+            Expect(offset, armv8::decode::PatternOf(kind));
+        }
+
+        Result Apply();
+        void Revert();
+
+        /* Applies every set that isn't yet, flushing all of them together. A set with a failed expectation is skipped
+           on its own and keeps reporting it through GetResult, the first such result is returned. */
+        static Result ApplyAll(std::span<PatchSet* const> sets);
+
+        inline Result SetApplied(bool applied) {
+            if(applied)
+                return Apply();
+
+            Revert();
+            return result::Success;
+        }
+
+        inline const char* GetName() const { return m_Name; }
+        inline bool IsApplied() const { return m_Applied; }
+        inline size_t GetCount() const { return m_Count; }
+        /* The result Apply will fail with, and where the expectation that caused it is and what was found there. */
+        inline Result GetResult() const { return m_Result; }
+        inline uintptr_t GetFailedOffset() const { return m_FailedOffset; }
+        inline armv8::InstType GetFailedInst() const { return m_FailedInst; }
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <common.hpp>
+#include <lib/armv8.hpp>
+
+#include <array>
+
+namespace exl::patch {
+
+    static constexpr size_t MaxSequenceInstructions = 8;
+
+    /* Instructions written back to back, built at compile time. */
+    struct InstSequence {
+        std::array<armv8::InstType, MaxSequenceInstructions> m_Insts {};
+        size_t m_Count = 0;
+
+        constexpr InstSequence() = default;
+
+        template<typename... Insts>
+        constexpr InstSequence(Insts... insts) : m_Insts { armv8::InstBitSet(insts).Value()... }, m_Count(sizeof...(Insts)) {
+            static_assert(sizeof...(Insts) <= MaxSequenceInstructions, "Too many instructions in sequence");
+        }
+
+        constexpr size_t GetSize() const { return m_Count * sizeof(armv8::InstType); }
+    };
+
+    /* One row of a patch table, at an offset from the main module's start. m_Expect matches anything unless given. */
+    struct TableEntry {
+        uintptr_t m_Offset;
+        InstSequence m_Code;
+        armv8::InstPattern m_Expect {};
+    };
+
+    namespace impl {
+        template<size_t N>
+        constexpr bool Overlaps(uintptr_t offset, size_t size, const TableEntry (&table)[N], size_t skip) {
+            for(size_t i = 0; i < N; i++) {
+                if(i == skip)
+                    continue;
+
+                uintptr_t other = table[i].m_Offset;
+                if(offset < other + table[i].m_Code.GetSize() && other < offset + size)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    /* True if any two entries of the given tables write over the same bytes, meant for static_assert. */
+    template<size_t N, size_t... Ns>
+    constexpr bool HasOverlap(const TableEntry (&table)[N], const TableEntry (&... others)[Ns]) {
+        for(size_t i = 0; i < N; i++) {
+            uintptr_t offset = table[i].m_Offset;
+            size_t size = table[i].m_Code.GetSize();
+
+            if(impl::Overlaps(offset, size, table, i))
+                return true;
+            if((impl::Overlaps(offset, size, others, Ns) || ...))
+                return true;
+        }
+
+        if constexpr(sizeof...(Ns) != 0)
+            return HasOverlap(others...);
+        else
+            return false;
+    }
+}
@@ -33,6 +33,12 @@ namespace exl::patch {
             return *ptr;
         }
 
+        /* A mismatch aborts right away, use a PatchSet to check sites without writing anything. */
+        inline void ExpectAt(const uintptr_t offset, armv8::InstPattern pattern) {
+            if(!pattern.Matches(At<armv8::InstType>(offset)))
+                EXL_ABORT(result::PatchExpectationFailed);
+        }
+
         public:
         inline PatcherImpl() : m_Pages(impl::GetRwPages()) {}
 
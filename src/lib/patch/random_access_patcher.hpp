@@ -38,6 +38,16 @@ namespace exl::patch {
             At<T>(addr) = value;
         }
 
+        inline void Expect(const uintptr_t addr, armv8::InstPattern pattern) {
+            ExpectAt(addr, pattern);
+        }
+        inline void Expect(const uintptr_t addr, armv8::InstType value, armv8::InstType mask) {
+            Expect(addr, armv8::InstPattern(value, mask));
+        }
+        inline void Expect(const uintptr_t addr, armv8::decode::InstKind kind) {
+            Expect(addr, armv8::decode::PatternOf(kind));
+        }
+
         template<typename T>
         T& Read(const uintptr_t index) {
             return At<T>(index);
@@ -50,6 +50,17 @@ namespace exl::patch {
             m_Current += sizeof(T);
         }
 
+        /* Checks the instruction at the current position, before anything is written over it. */
+        inline void Expect(armv8::InstPattern pattern) {
+            ExpectAt(m_Current, pattern);
+        }
+        inline void Expect(armv8::InstType value, armv8::InstType mask) {
+            Expect(armv8::InstPattern(value, mask));
+        }
+        inline void Expect(armv8::decode::InstKind kind) {
+            Expect(armv8::decode::PatternOf(kind));
+        }
+
         /* Flush current data then move to a new address. */
         inline void SeekRel(uintptr_t address) {
             /* Don't need to do anything if the address doesn't need to change. */
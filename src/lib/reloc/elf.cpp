@@ -2,6 +2,7 @@
 
 #include "common.hpp"
 
+#include "relocate.hpp"
 #include "rtld.hpp"
 
 extern "C" {
@@ -22,6 +23,9 @@ extern "C" {
         Elf_Xword rela_size = 0;
         Elf_Xword rel_size = 0;
 
+        Elf_Addr relr = 0;
+        Elf_Xword relr_size = 0;
+
         for (; dynamic->d_tag != DT_NULL; dynamic++) {
             switch (dynamic->d_tag) {
                 case DT_RELA:
@@ -56,6 +60,14 @@ extern "C" {
                     rel_entry_count = dynamic->d_un.d_val;
                     continue;
 
+                case DT_RELR:
+                    relr = ((Elf_Addr)aslr_base + dynamic->d_un.d_ptr);
+                    continue;
+
+                case DT_RELRSZ:
+                    relr_size = dynamic->d_un.d_val;
+                    continue;
+
                 // those are nop on the real rtld
                 case DT_NEEDED:
                 case DT_PLTRELSZ:
@@ -75,43 +87,46 @@ extern "C" {
             }
         }
         
-        if(rela_entry_count == 0)
-            rela_entry_count = rela_size / rela_entry_size;
-        if(rel_entry_count == 0)
-            rel_entry_count = rel_size / rel_entry_size;
-
-
-        if (rel_entry_count) {
-            Elf_Xword i = 0;
-
-            while (i < rel_entry_count) {
-                Elf_Rel *entry = (Elf_Rel *)(rel + (i * rel_entry_size));
-                switch (ELF_R_TYPE(entry->r_info)) {
-                    case ARCH_RELATIVE: {
-                        Elf_Addr *ptr = (Elf_Addr *)(aslr_base + entry->r_offset);
-                        *ptr += (Elf_Addr)aslr_base;
-                        break;
-                    }
+        /* Only entries past the counted R_*_RELATIVE prefix need their type checked. */
+        const Elf_Xword rel_total = rel_size / rel_entry_size;
+        const Elf_Xword rela_total = rela_size / rela_entry_size;
+
+        if (rel_entry_size == sizeof(Elf_Rel)) {
+            exl::reloc::ApplyRelative(aslr_base, (const Elf_Rel *)rel, rel_entry_count);
+        } else {
+            rel_entry_count = 0;
+        }
+
+        for (Elf_Xword i = rel_entry_count; i < rel_total; i++) {
+            Elf_Rel *entry = (Elf_Rel *)(rel + (i * rel_entry_size));
+            switch (ELF_R_TYPE(entry->r_info)) {
+                case ARCH_RELATIVE: {
+                    Elf_Addr *ptr = (Elf_Addr *)(aslr_base + entry->r_offset);
+                    *ptr += (Elf_Addr)aslr_base;
+                    break;
                 }
-                i++;
             }
         }
 
-        if (rela_entry_count) {
-            Elf_Xword i = 0;
+        if (rela_entry_size == sizeof(Elf_Rela)) {
+            exl::reloc::ApplyRelative(aslr_base, (const Elf_Rela *)rela, rela_entry_count);
+        } else {
+            rela_entry_count = 0;
+        }
 
-            while (i < rela_entry_count) {
-                Elf_Rela *entry = (Elf_Rela *)(rela + (i * rela_entry_size));
+        for (Elf_Xword i = rela_entry_count; i < rela_total; i++) {
+            Elf_Rela *entry = (Elf_Rela *)(rela + (i * rela_entry_size));
 
-                switch (ELF_R_TYPE(entry->r_info)) {
-                    case ARCH_RELATIVE: {
-                        Elf_Addr *ptr = (Elf_Addr *)(aslr_base + entry->r_offset);
-                        *ptr = (Elf_Addr)aslr_base + entry->r_addend;
-                        break;
-                    }
+            switch (ELF_R_TYPE(entry->r_info)) {
+                case ARCH_RELATIVE: {
+                    Elf_Addr *ptr = (Elf_Addr *)(aslr_base + entry->r_offset);
+                    *ptr = (Elf_Addr)aslr_base + entry->r_addend;
+                    break;
                 }
-                i++;
             }
         }
+
+        if (relr_size != 0)
+            exl::reloc::ApplyRelr(aslr_base, (const Elf_Relr *)relr, relr_size / sizeof(Elf_Relr));
     }
 };
\ No newline at end of file
@@ -2,6 +2,16 @@
 
 #include <elf.h>
 
+#ifndef DT_GNU_HASH
+#define DT_GNU_HASH 0x6ffffef5
+#endif
+
+#ifndef DT_RELR
+#define DT_RELRSZ 35
+#define DT_RELR 36
+#define DT_RELRENT 37
+#endif
+
 /* TODO: 32-bit support? */
 typedef Elf64_Addr Elf_Addr;
 typedef Elf64_Rel Elf_Rel;
@@ -9,6 +19,8 @@ typedef Elf64_Rela Elf_Rela;
 typedef Elf64_Dyn Elf_Dyn;
 typedef Elf64_Sym Elf_Sym;
 typedef Elf64_Xword Elf_Xword;
+/* Not every elf.h has Elf64_Relr yet. */
+typedef Elf64_Xword Elf_Relr;
 
 #define ELF_R_SYM ELF64_R_SYM
 #define ELF_R_TYPE ELF64_R_TYPE
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "common.hpp"
+
+#include "elf.hpp"
+
+namespace exl::reloc {
+
+    namespace impl {
+        /* Entries ahead of the one being applied that get pulled into cache. */
+        static constexpr size_t PrefetchDistance = 8;
+    }
+
+    /* The linker sorts R_*_RELATIVE first and counts them in DT_RELACOUNT, so those need no type check. */
+    ALWAYS_INLINE void ApplyRelative(uintptr_t base, const Elf_Rela* entries, size_t count) {
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4) {
+            __builtin_prefetch(&entries[i + impl::PrefetchDistance]);
+
+            const Elf_Rela& e0 = entries[i + 0];
+            const Elf_Rela& e1 = entries[i + 1];
+            const Elf_Rela& e2 = entries[i + 2];
+            const Elf_Rela& e3 = entries[i + 3];
+            *reinterpret_cast<Elf_Addr*>(base + e0.r_offset) = base + e0.r_addend;
+            *reinterpret_cast<Elf_Addr*>(base + e1.r_offset) = base + e1.r_addend;
+            *reinterpret_cast<Elf_Addr*>(base + e2.r_offset) = base + e2.r_addend;
+            *reinterpret_cast<Elf_Addr*>(base + e3.r_offset) = base + e3.r_addend;
+        }
+
+        for(; i < count; i++)
+            *reinterpret_cast<Elf_Addr*>(base + entries[i].r_offset) = base + entries[i].r_addend;
+    }
+
+    ALWAYS_INLINE void ApplyRelative(uintptr_t base, const Elf_Rel* entries, size_t count) {
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4) {
+            __builtin_prefetch(&entries[i + impl::PrefetchDistance]);
+
+            *reinterpret_cast<Elf_Addr*>(base + entries[i + 0].r_offset) += base;
+            *reinterpret_cast<Elf_Addr*>(base + entries[i + 1].r_offset) += base;
+            *reinterpret_cast<Elf_Addr*>(base + entries[i + 2].r_offset) += base;
+            *reinterpret_cast<Elf_Addr*>(base + entries[i + 3].r_offset) += base;
+        }
+
+        for(; i < count; i++)
+            *reinterpret_cast<Elf_Addr*>(base + entries[i].r_offset) += base;
+    }
+
+    /* Packed relative relocations (DT_RELR). An even entry is the offset of one relocation, an odd entry is a bitmap of
+       which of the following 63 words are relocated. */
+    ALWAYS_INLINE void ApplyRelr(uintptr_t base, const Elf_Relr* entries, size_t count) {
+        constexpr size_t BitsPerEntry = sizeof(Elf_Relr) * 8 - 1;
+
+        Elf_Addr* where = nullptr;
+        for(size_t i = 0; i < count; i++) {
+            const Elf_Relr entry = entries[i];
+
+            if((entry & 1) == 0) {
+                where = reinterpret_cast<Elf_Addr*>(base + entry);
+                *where++ += base;
+                continue;
+            }
+
+            Elf_Relr bits = entry >> 1;
+            while(bits != 0) {
+                const size_t index = __builtin_ctzll(bits);
+                where[index] += base;
+                bits &= bits - 1;
+            }
+            where += BitsPerEntry;
+        }
+    }
+}
@@ -2,12 +2,110 @@
 
 #include <string.h>
 
+#include <atomic>
+
+#include "lib/reloc/relocate.hpp"
 #include "lib/reloc/rtld.hpp"
 #include "lib/diag/assert.hpp"
 #include "utils.hpp"
 
 namespace rtld {
 
+namespace {
+
+// Enough for every module of the process plus any loaded manually through ro.
+constexpr size_t MaxGnuHashEntries = 32;
+
+struct GnuHashEntry {
+    std::atomic<const ModuleObject *> module;
+    bool is_present;
+    GnuHashTable table;
+};
+
+GnuHashEntry g_GnuHashEntries[MaxGnuHashEntries];
+std::atomic<size_t> g_GnuHashEntryCount;
+
+bool ReadGnuHashTable(GnuHashTable *out_table, const uint32_t *header) {
+    if (header == nullptr) {
+        return false;
+    }
+
+    const uint32_t nbucket = header[0];
+    const uint32_t bloom_size = header[2];
+
+    // bloom_size must be a power of two, as required by the GNU toolchain.
+    if (nbucket == 0 || bloom_size == 0 ||
+        (bloom_size & (bloom_size - 1)) != 0) {
+        return false;
+    }
+
+    const Elf_Xword *bloom = (const Elf_Xword *)&header[4];
+    const uint32_t *buckets = (const uint32_t *)&bloom[bloom_size];
+
+    out_table->nbucket = nbucket;
+    out_table->symoffset = header[1];
+    out_table->bloom_size = bloom_size;
+    out_table->bloom_shift = header[3];
+    out_table->bloom = bloom;
+    out_table->buckets = buckets;
+    out_table->chain = &buckets[nbucket];
+    return true;
+}
+
+const uint32_t *FindGnuHashHeader(char *module_base, Elf_Dyn *dynamic) {
+    if (dynamic == nullptr) {
+        return nullptr;
+    }
+
+    for (; dynamic->d_tag != DT_NULL; dynamic++) {
+        if (dynamic->d_tag == DT_GNU_HASH) {
+            return (const uint32_t *)(module_base + dynamic->d_un.d_val);
+        }
+    }
+    return nullptr;
+}
+
+const GnuHashEntry *FindGnuHashEntry(const ModuleObject *module) {
+    size_t count = g_GnuHashEntryCount.load(std::memory_order_acquire);
+    if (count > MaxGnuHashEntries) {
+        count = MaxGnuHashEntries;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        // Entries still being filled have no module yet and are skipped.
+        if (g_GnuHashEntries[i].module.load(std::memory_order_acquire) ==
+            module) {
+            return &g_GnuHashEntries[i];
+        }
+    }
+    return nullptr;
+}
+
+// Modules without DT_GNU_HASH are recorded too, so they are only scanned once.
+// Two threads racing on the same module may both add an entry, which is
+// harmless as both describe the same table.
+void CacheGnuHashTable(const ModuleObject *module, bool is_present,
+                       const GnuHashTable &table) {
+    size_t index = g_GnuHashEntryCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= MaxGnuHashEntries) {
+        return;
+    }
+
+    GnuHashEntry &entry = g_GnuHashEntries[index];
+    entry.is_present = is_present;
+    entry.table = table;
+    entry.module.store(module, std::memory_order_release);
+}
+
+}  // namespace
+
+SymbolNameHash SymbolNameHash::Compute(const char *name) {
+    return {
+        .elf_hash = __rtld_elf_hash(name),
+        .gnu_hash = __rtld_gnu_hash(name),
+    };
+}
+
 void ModuleObject::Initialize(char *aslr_base, Elf_Dyn *dynamic) {
 #ifdef __RTLD_6XX__
     this->nro_size = 0;
@@ -33,6 +131,7 @@ void ModuleObject::Initialize(char *aslr_base, Elf_Dyn *dynamic) {
     this->got_stub_ptr = 0;
 
     void *rel_plt = nullptr;
+    const uint32_t *gnu_hash = nullptr;
 
     for (; dynamic->d_tag != DT_NULL; dynamic++) {
         switch (dynamic->d_tag) {
@@ -60,6 +159,11 @@ void ModuleObject::Initialize(char *aslr_base, Elf_Dyn *dynamic) {
                 break;
             }
 
+            case DT_GNU_HASH: {
+                gnu_hash = (const uint32_t *)(aslr_base + dynamic->d_un.d_val);
+                break;
+            }
+
             case DT_STRTAB: {
                 this->dynstr = (char *)(aslr_base + dynamic->d_un.d_val);
                 break;
@@ -88,7 +192,7 @@ void ModuleObject::Initialize(char *aslr_base, Elf_Dyn *dynamic) {
             }
 
             case DT_RELAENT: {
-                EXL_ASSERT(dynamic->d_un.d_val != sizeof(Elf_Rela));
+                EXL_ASSERT(dynamic->d_un.d_val == sizeof(Elf_Rela));
                 break;
             }
 
@@ -159,42 +263,90 @@ void ModuleObject::Initialize(char *aslr_base, Elf_Dyn *dynamic) {
     }
 
     this->rela_or_rel_plt.raw = rel_plt;
+
+    GnuHashTable gnu_hash_table = {};
+    bool has_gnu_hash = ReadGnuHashTable(&gnu_hash_table, gnu_hash);
+    CacheGnuHashTable(this, has_gnu_hash, gnu_hash_table);
 }
 
 void ModuleObject::Relocate() {
+    // rel_count and rela_count come from DT_RELCOUNT and DT_RELACOUNT, which
+    // only count the leading R_*_RELATIVE entries, so no type check is needed.
     if (this->rel_count) {
-        for (auto i = 0u; i < this->rel_count; i++) {
-            Elf_Rel *entry = &this->rela_or_rel.rel[i];
-            switch (ELF_R_TYPE(entry->r_info)) {
-                case ARCH_RELATIVE: {
-                    Elf_Addr *ptr =
-                        (Elf_Addr *)(this->module_base + entry->r_offset);
-                    *ptr += (Elf_Addr)this->module_base;
-                    break;
-                }
-            }
-        }
+        exl::reloc::ApplyRelative((uintptr_t)this->module_base,
+                                  this->rela_or_rel.rel, this->rel_count);
     }
 
     if (this->rela_count) {
-        for (auto i = 0u; i < this->rela_count; i++) {
-            Elf_Rela *entry = &this->rela_or_rel.rela[i];
-            switch (ELF_R_TYPE(entry->r_info)) {
-                case ARCH_RELATIVE: {
-                    Elf_Addr *ptr =
-                        (Elf_Addr *)(this->module_base + entry->r_offset);
-                    *ptr = (Elf_Addr)this->module_base + entry->r_addend;
-                    break;
-                }
+        exl::reloc::ApplyRelative((uintptr_t)this->module_base,
+                                  this->rela_or_rel.rela, this->rela_count);
+    }
+}
+
+bool ModuleObject::GetGnuHashTable(GnuHashTable *out_table) {
+    if (const GnuHashEntry *entry = FindGnuHashEntry(this)) {
+        if (entry->is_present) {
+            *out_table = entry->table;
+        }
+        return entry->is_present;
+    }
+
+    // Modules initialized by the system rtld never went through Initialize, so
+    // their dynamic section is scanned on first use.
+    bool is_present = ReadGnuHashTable(
+        out_table, FindGnuHashHeader(this->module_base, this->dynamic));
+    CacheGnuHashTable(this, is_present, is_present ? *out_table : GnuHashTable{});
+    return is_present;
+}
+
+Elf_Sym *ModuleObject::GetSymbolByGnuHash(const GnuHashTable &table,
+                                          const char *name,
+                                          uint32_t gnu_hash) {
+    // The bloom filter rejects most misses without touching the buckets.
+    constexpr uint32_t word_bits = sizeof(Elf_Xword) * 8;
+    Elf_Xword word =
+        table.bloom[(gnu_hash / word_bits) & (table.bloom_size - 1)];
+    Elf_Xword mask = ((Elf_Xword)1 << (gnu_hash % word_bits)) |
+                     ((Elf_Xword)1 << ((gnu_hash >> table.bloom_shift) %
+                                       word_bits));
+    if ((word & mask) != mask) {
+        return nullptr;
+    }
+
+    uint32_t i = table.buckets[gnu_hash % table.nbucket];
+    if (i < table.symoffset) {
+        return nullptr;
+    }
+
+    for (;; i++) {
+        // The low bit of a chain entry marks the end of the bucket, the
+        // remaining bits are compared before falling back to strcmp.
+        uint32_t chain_hash = table.chain[i - table.symoffset];
+        if (((chain_hash ^ gnu_hash) >> 1) == 0) {
+            bool is_common = this->dynsym[i].st_shndx
+                                 ? this->dynsym[i].st_shndx == SHN_COMMON
+                                 : true;
+            if (!is_common &&
+                strcmp(name, this->dynstr + this->dynsym[i].st_name) == 0) {
+                return &this->dynsym[i];
             }
         }
+
+        if (chain_hash & 1) {
+            break;
+        }
     }
+
+    return nullptr;
 }
 
-Elf_Sym *ModuleObject::GetSymbolByName(const char *name) {
-    unsigned long name_hash = __rtld_elf_hash(name);
+Elf_Sym *ModuleObject::GetSymbolByElfHash(const char *name,
+                                          unsigned long elf_hash) {
+    if (this->hash_bucket == nullptr) {
+        return nullptr;
+    }
 
-    for (uint32_t i = this->hash_bucket[name_hash % this->hash_nbucket_value];
+    for (uint32_t i = this->hash_bucket[elf_hash % this->hash_nbucket_value];
          i; i = this->hash_chain[i]) {
         bool is_common = this->dynsym[i].st_shndx
                              ? this->dynsym[i].st_shndx == SHN_COMMON
@@ -208,6 +360,20 @@ Elf_Sym *ModuleObject::GetSymbolByName(const char *name) {
     return nullptr;
 }
 
+Elf_Sym *ModuleObject::GetSymbolByName(const char *name,
+                                       const SymbolNameHash &hash) {
+    GnuHashTable table;
+    if (this->GetGnuHashTable(&table)) {
+        return this->GetSymbolByGnuHash(table, name, hash.gnu_hash);
+    }
+
+    return this->GetSymbolByElfHash(name, hash.elf_hash);
+}
+
+Elf_Sym *ModuleObject::GetSymbolByName(const char *name) {
+    return this->GetSymbolByName(name, SymbolNameHash::Compute(name));
+}
+
 bool ModuleObject::TryResolveSymbol(Elf_Addr *target_symbol_address,
                                     Elf_Sym *symbol) {
     const char *name = &this->dynstr[symbol->st_name];
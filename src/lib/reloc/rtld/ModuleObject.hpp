@@ -9,6 +9,26 @@
 
 namespace rtld {
 
+// Parsed DT_GNU_HASH section. ModuleObject's layout is shared with the system
+// rtld, so these live in a side table keyed by module instead of in the object.
+struct GnuHashTable {
+    uint32_t nbucket;
+    uint32_t symoffset;
+    uint32_t bloom_size;
+    uint32_t bloom_shift;
+    const Elf_Xword *bloom;
+    const uint32_t *buckets;
+    const uint32_t *chain;
+};
+
+// Both hashes of a symbol name, computed once per lookup across every module.
+struct SymbolNameHash {
+    unsigned long elf_hash;
+    uint32_t gnu_hash;
+
+    static SymbolNameHash Compute(const char *name);
+};
+
 struct ModuleObject {
 
    private:
@@ -19,6 +39,10 @@ struct ModuleObject {
     inline void ResolveSymbolRelaJumpSlot(Elf_Rela *entry,
                                           bool do_lazy_got_init);
 
+    Elf_Sym *GetSymbolByGnuHash(const GnuHashTable &table, const char *name,
+                                uint32_t gnu_hash);
+    Elf_Sym *GetSymbolByElfHash(const char *name, unsigned long elf_hash);
+
    public:
     struct ModuleObject *next;
     struct ModuleObject *prev;
@@ -59,6 +83,8 @@ struct ModuleObject {
     void Initialize(char *aslr_base, Elf_Dyn *dynamic);
     void Relocate();
     Elf_Sym *GetSymbolByName(const char *name);
+    Elf_Sym *GetSymbolByName(const char *name, const SymbolNameHash &hash);
+    bool GetGnuHashTable(GnuHashTable *out_table);
     void ResolveSymbols(bool do_lazy_got_init);
     bool TryResolveSymbol(Elf_Addr *target_symbol_address, Elf_Sym *symbol);
 };
@@ -6,8 +6,11 @@ Elf_Addr rtld::lookup_global_auto(const char *name) {
         return 0;
     }
 
+    // Hash once, every module in the list is searched with the same name.
+    SymbolNameHash hash = SymbolNameHash::Compute(name);
+
     for (ModuleObject *module : ro::g_pAutoLoadList) {
-        Elf_Sym *symbol = module->GetSymbolByName(name);
+        Elf_Sym *symbol = module->GetSymbolByName(name, hash);
         if (symbol && ELF_ST_BIND(symbol->st_info)) {
             return (Elf_Addr)module->module_base + symbol->st_value;
         }
@@ -26,5 +26,13 @@ namespace exl::result {
     constexpr Result HookFixingTooManyInstructions  = MakeResult(ExlModule, 3);
     constexpr Result FailedToFindTarget             = MakeResult(ExlModule, 4);
     constexpr Result TooManyStaticModules           = MakeResult(ExlModule, 5);
+    constexpr Result HookNotFound                   = MakeResult(ExlModule, 6);
+    constexpr Result HookNotToggleable              = MakeResult(ExlModule, 7);
+    constexpr Result ArmOperandOutOfRange           = MakeResult(ExlModule, 8);
+    constexpr Result PatchExpectationFailed         = MakeResult(ExlModule, 9);
+    constexpr Result PatchSetFull                   = MakeResult(ExlModule, 10);
+    constexpr Result PatchOverlap                   = MakeResult(ExlModule, 11);
+    constexpr Result HookRegistryFull               = MakeResult(ExlModule, 12);
+    constexpr Result HookChainDropsListener         = MakeResult(ExlModule, 13);
     
 }
\ No newline at end of file
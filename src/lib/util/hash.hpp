@@ -0,0 +1,37 @@
+#pragma once
+
+#include <common.hpp>
+#include <string_view>
+
+namespace exl::util {
+
+    namespace impl {
+        constexpr u32 Fnv1aOffset32 = 0x811C9DC5;
+        constexpr u32 Fnv1aPrime32 = 0x01000193;
+        constexpr u64 Fnv1aOffset64 = 0xCBF29CE484222325;
+        constexpr u64 Fnv1aPrime64 = 0x00000100000001B3;
+    }
+
+    /* FNV-1a, usable both at compile time and at runtime. */
+    constexpr u32 HashFnv1a32(std::string_view str) {
+        u32 hash = impl::Fnv1aOffset32;
+        for(char c : str) {
+            hash ^= static_cast<u8>(c);
+            hash *= impl::Fnv1aPrime32;
+        }
+        return hash;
+    }
+
+    constexpr u64 HashFnv1a64(std::string_view str) {
+        u64 hash = impl::Fnv1aOffset64;
+        for(char c : str) {
+            hash ^= static_cast<u8>(c);
+            hash *= impl::Fnv1aPrime64;
+        }
+        return hash;
+    }
+
+    static_assert(HashFnv1a32("") == 0x811C9DC5, "");
+    static_assert(HashFnv1a32("a") == 0xE40C292C, "");
+    static_assert(HashFnv1a64("a") == 0xAF63DC4C8601EC8C, "");
+}
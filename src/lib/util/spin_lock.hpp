@@ -0,0 +1,41 @@
+#pragma once
+
+#include <common.hpp>
+
+#include <atomic>
+
+namespace exl::util {
+
+    /* For short critical sections only, waiters burn their core until the lock is free. */
+    class SpinLock {
+        NON_COPYABLE(SpinLock);
+        NON_MOVEABLE(SpinLock);
+
+        std::atomic_flag m_Flag = ATOMIC_FLAG_INIT;
+
+        public:
+        constexpr SpinLock() = default;
+
+        ALWAYS_INLINE void Lock() {
+            while(m_Flag.test_and_set(std::memory_order_acquire)) {
+                while(m_Flag.test(std::memory_order_relaxed))
+                    asm volatile("yield");
+            }
+        }
+
+        ALWAYS_INLINE void Unlock() {
+            m_Flag.clear(std::memory_order_release);
+        }
+    };
+
+    class ScopedSpinLock {
+        NON_COPYABLE(ScopedSpinLock);
+        NON_MOVEABLE(ScopedSpinLock);
+
+        SpinLock& m_Lock;
+
+        public:
+        ALWAYS_INLINE ScopedSpinLock(SpinLock& lock) : m_Lock(lock) { m_Lock.Lock(); }
+        ALWAYS_INLINE ~ScopedSpinLock() { m_Lock.Unlock(); }
+    };
+}
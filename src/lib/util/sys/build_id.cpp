@@ -0,0 +1,43 @@
+#include "build_id.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace exl::util {
+
+    namespace {
+        constexpr u32 NoteTypeGnuBuildId = 3;
+        constexpr char NoteNameGnu[4] = { 'G', 'N', 'U', '\0' };
+
+        struct NoteHeader {
+            u32 m_NameSize;
+            u32 m_DescSize;
+            u32 m_Type;
+            char m_Name[sizeof(NoteNameGnu)];
+        };
+    }
+
+    bool GetModuleBuildId(BuildId* out, const ModuleInfo& info) {
+        const auto& rodata = info.m_Rodata;
+
+        /* Notes are 4-byte aligned, and the build ID note is placed near the start of rodata. */
+        for(uintptr_t address = rodata.m_Start; address + sizeof(NoteHeader) <= rodata.GetEnd(); address += sizeof(u32)) {
+            const NoteHeader* note = reinterpret_cast<const NoteHeader*>(address);
+
+            if(note->m_Type != NoteTypeGnuBuildId || note->m_NameSize != sizeof(NoteNameGnu))
+                continue;
+            if(note->m_DescSize == 0 || note->m_DescSize > out->size())
+                continue;
+            if(std::memcmp(note->m_Name, NoteNameGnu, sizeof(NoteNameGnu)) != 0)
+                continue;
+            if(address + sizeof(NoteHeader) + note->m_DescSize > rodata.GetEnd())
+                continue;
+
+            out->fill(0);
+            std::memcpy(out->data(), reinterpret_cast<const void*>(address + sizeof(NoteHeader)), note->m_DescSize);
+            return true;
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common.hpp"
+#include "mem_layout.hpp"
+
+#include <array>
+
+namespace exl::util {
+
+    using BuildId = std::array<u8, 0x20>;
+
+    /* Finds the GNU build ID note in a module's rodata. Returns false if the module has none. */
+    bool GetModuleBuildId(BuildId* out, const ModuleInfo& info);
+
+    inline bool GetMainModuleBuildId(BuildId* out) {
+        return GetModuleBuildId(out, GetMainModuleInfo());
+    }
+}
@@ -4,6 +4,8 @@
 #include "lib/util/typed_storage.hpp"
 #include "rw_pages.hpp"
 
+#include <array>
+#include <atomic>
 #include <span>
 
 #define JIT_CREATE(name, size)                          \
@@ -14,6 +16,14 @@
     }                                                   \
     exl::util::Jit name(std::span(impl::name::s_Area));
 
+#define JIT_POOL_CREATE(name, block_size, block_count)                  \
+    namespace impl::name {                                              \
+        __attribute__((section(".text." #name)))                        \
+        alignas(PAGE_SIZE)                                              \
+        static const std::array<u8, (block_size) * (block_count)> s_Area {}; \
+    }                                                                   \
+    exl::util::JitPool<(block_size), (block_count)> name(std::span(impl::name::s_Area));
+
 namespace exl::util {
 
     class Jit {
@@ -36,4 +46,68 @@ namespace exl::util {
         inline uintptr_t GetRw() { return GetPages().GetRw(); }
         inline uintptr_t GetSize() { return GetPages().GetSize(); }
     };
+
+    /* JIT area split into blocks that are only mapped rw the first time they are used. */
+    template<size_t BlockSize, size_t BlockCount>
+    class JitPool {
+        static_assert(ALIGN_UP(BlockSize, PAGE_SIZE) == BlockSize, "");
+
+        enum BlockState : u8 {
+            BlockState_Unmapped,
+            BlockState_Mapping,
+            BlockState_Mapped,
+        };
+
+        std::span<const u8> m_Rx;
+        std::array<util::TypedStorage<RwPages>, BlockCount> m_Pages;
+        std::array<std::atomic<u8>, BlockCount> m_States {};
+
+        inline RwPages& GetPages(size_t index) { return util::GetReference(m_Pages[index]); }
+
+        public:
+        static constexpr size_t GetBlockSize() { return BlockSize; }
+        static constexpr size_t GetBlockCount() { return BlockCount; }
+
+        constexpr JitPool(std::span<const u8> rx) : m_Rx(rx) {}
+
+        /* Safe to call from multiple threads, only the first caller maps the block. */
+        void MapBlock(size_t index) {
+            EXL_ASSERT(index < BlockCount);
+
+            u8 expected = BlockState_Unmapped;
+            if(m_States[index].compare_exchange_strong(expected, BlockState_Mapping, std::memory_order_acq_rel)) {
+                util::ConstructAt(m_Pages[index], reinterpret_cast<uintptr_t>(m_Rx.data()) + index * BlockSize, BlockSize);
+                m_States[index].store(BlockState_Mapped, std::memory_order_release);
+                return;
+            }
+
+            /* Another thread is mapping this block, wait for it to finish. */
+            while(m_States[index].load(std::memory_order_acquire) != BlockState_Mapped)
+                svcSleepThread(0);
+        }
+
+        inline bool IsBlockMapped(size_t index) const {
+            return m_States[index].load(std::memory_order_acquire) == BlockState_Mapped;
+        }
+
+        size_t GetMappedBlockCount() const {
+            size_t count = 0;
+            for(size_t i = 0; i < BlockCount; i++) {
+                if(IsBlockMapped(i))
+                    count++;
+            }
+            return count;
+        }
+
+        /* Flushes every block that has been mapped so far. */
+        void Flush() {
+            for(size_t i = 0; i < BlockCount; i++) {
+                if(IsBlockMapped(i))
+                    GetPages(i).Flush();
+            }
+        }
+
+        inline uintptr_t GetBlockRo(size_t index) { return GetPages(index).GetRo(); }
+        inline uintptr_t GetBlockRw(size_t index) { return GetPages(index).GetRw(); }
+    };
 }
\ No newline at end of file
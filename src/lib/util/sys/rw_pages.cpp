@@ -1,8 +1,11 @@
 #include "rw_pages.hpp"
 
 #include "lib/util/sys/cur_proc_handle.hpp"
+#include "lib/util/spin_lock.hpp"
+#include "program/setting.hpp"
 #include <cstring>
 #include <algorithm>
+#include <array>
 #include <functional>
 
 namespace exl::util {
@@ -34,6 +37,123 @@ namespace exl::util {
         } while((meminfo.addr + meminfo.size) < end);
     }
 
+    struct RwPages::Mapping {
+        uintptr_t m_AlignedRo;
+        size_t m_AlignedSize;
+        uintptr_t m_AlignedRw;
+        VirtmemReservation* m_Reserve;
+        size_t m_RefCount;
+
+        constexpr bool IsFree() const { return m_AlignedSize == 0; }
+
+        constexpr bool Contains(uintptr_t aligned_ro, size_t aligned_size) const {
+            return !IsFree() && m_AlignedRo <= aligned_ro && aligned_ro + aligned_size <= m_AlignedRo + m_AlignedSize;
+        }
+    };
+
+    namespace {
+        /* Hooks map a page or two at a time, most of them on pages the patchers' module-wide mapping already covers. */
+        constexpr size_t MaxMappings = 32;
+
+        constinit std::array<RwPages::Mapping, MaxMappings> s_Mappings {};
+        /* Also covers virtmem, which has no locking of its own. */
+        constinit SpinLock s_MappingsLock;
+
+        void Map(RwPages::Mapping& mapping, uintptr_t aligned_ro, size_t aligned_size) {
+            /* Find space for the corresponding rw region. */
+            uintptr_t alignedRw = (uintptr_t) virtmemFindAslr(aligned_size, 0);
+            EXL_ASSERT(alignedRw != 0);
+
+            /* Reserve rw region. */
+            auto reserve = virtmemAddReservation((void*)alignedRw, aligned_size);
+            EXL_ASSERT(reserve != NULL);
+
+            auto procHandle = proc_handle::Get();
+
+            /* Iterate through every range and map. */
+            ForEachMemRange(
+                [alignedRw, procHandle](uintptr_t address, uintptr_t size, uintptr_t offset) {
+                    void* rw = (void*) (alignedRw + offset);
+                    u64 ro = address;
+
+                    R_ABORT_UNLESS(svcMapProcessMemory(rw, procHandle, ro, size));
+                }
+            , aligned_ro, aligned_size);
+
+            mapping = {
+                .m_AlignedRo = aligned_ro,
+                .m_AlignedSize = aligned_size,
+                .m_AlignedRw = alignedRw,
+                .m_Reserve = reserve,
+                .m_RefCount = 0,
+            };
+        }
+
+        void Unmap(RwPages::Mapping& mapping) {
+            auto procHandle = proc_handle::Get();
+
+            /* Iterate through every range and unmap. */
+            ForEachMemRange(
+                [&mapping, procHandle](uintptr_t address, uintptr_t size, uintptr_t offset) {
+                    void* rw = reinterpret_cast<void*>(mapping.m_AlignedRw + offset);
+                    u64 ro = address;
+
+                    R_ABORT_UNLESS(svcUnmapProcessMemory(rw, procHandle, ro, size));
+                }
+            , mapping.m_AlignedRo, mapping.m_AlignedSize);
+
+            /* Free RW reservation. */
+            virtmemRemoveReservation(mapping.m_Reserve);
+            mapping = {};
+        }
+
+        RwPages::Mapping& AcquireMapping(uintptr_t aligned_ro, size_t aligned_size) {
+            ScopedSpinLock lock(s_MappingsLock);
+
+            /* Reuse a mapping that covers every page, preferring one in use so idle ones are the first to go. */
+            RwPages::Mapping* found = nullptr;
+            for(auto& mapping : s_Mappings) {
+                if(mapping.Contains(aligned_ro, aligned_size) && (found == nullptr || found->m_RefCount == 0))
+                    found = &mapping;
+            }
+
+            if(found == nullptr) {
+                for(auto& mapping : s_Mappings) {
+                    if(mapping.IsFree()) {
+                        found = &mapping;
+                        break;
+                    }
+                }
+            }
+
+            if(found == nullptr) {
+                /* Make room by dropping an idle mapping. */
+                for(auto& mapping : s_Mappings) {
+                    if(mapping.m_RefCount == 0) {
+                        Unmap(mapping);
+                        found = &mapping;
+                        break;
+                    }
+                }
+                EXL_ASSERT(found != nullptr);
+            }
+
+            if(found->IsFree())
+                Map(*found, aligned_ro, aligned_size);
+
+            found->m_RefCount++;
+            return *found;
+        }
+
+        void ReleaseMapping(RwPages::Mapping& mapping) {
+            ScopedSpinLock lock(s_MappingsLock);
+
+            /* Kept mapped, it is unmapped once the pool needs the slot. */
+            EXL_ASSERT(mapping.m_RefCount != 0);
+            mapping.m_RefCount--;
+        }
+    }
+
     RwPages::RwPages(uintptr_t ro, size_t size)  {
         /* Initialize the claim with what we know. */
         m_Claim = {
@@ -44,32 +164,16 @@ namespace exl::util {
         /* Get const ref to claim. */
         const auto& claim = GetClaim();
 
-        /* Find space for the corresponding rw region. */
-        uintptr_t alignedRw = (uintptr_t) virtmemFindAslr(claim.GetAlignedSize(), 0);
-        EXL_ASSERT(alignedRw != 0);
-
-        /* Reserve rw region. */
-        auto reserve = virtmemAddReservation((void*)alignedRw, claim.GetAlignedSize());
-        EXL_ASSERT(reserve != NULL);
-        m_Claim.m_RwReserve = reserve;
-
-        auto procHandle = proc_handle::Get();
-
-        /* Iterate through every range and map. */
-        ForEachMemRange(
-            [alignedRw, procHandle](uintptr_t address, uintptr_t size, uintptr_t offset) {
-                void* rw = (void*) (alignedRw + offset);
-                u64 ro = address;
-
-                R_ABORT_UNLESS(svcMapProcessMemory(rw, procHandle, ro, size));
-            }
-        , claim.GetAlignedRo(), claim.GetAlignedSize());
+        Mapping& mapping = AcquireMapping(claim.GetAlignedRo(), claim.GetAlignedSize());
+        m_Claim.m_Mapping = &mapping;
 
         /* Setup RW pointer to match same physical location of RX. */
-        m_Claim.m_Rw = alignedRw + (ro - claim.GetAlignedRo());
+        m_Claim.m_Rw = mapping.m_AlignedRw + (ro - mapping.m_AlignedRo);
 
+    #ifdef EXL_VERIFY_RW_PAGES
         /* Ensure the data at the different mapping is the same. */
         EXL_ASSERT(memcmp((void*)claim.m_Ro, (void*)claim.m_Rw, size) == 0);
+    #endif
     }
 
     void RwPages::Flush() {
@@ -88,19 +192,6 @@ namespace exl::util {
         armDCacheFlush((void*)claim.m_Rw, claim.m_Size);
         armICacheInvalidate((void*)claim.m_Ro, claim.m_Size);
 
-        auto procHandle = proc_handle::Get();
-        
-        /* Iterate through every range and unmap. */
-        ForEachMemRange(
-            [&claim, procHandle](uintptr_t address, uintptr_t size, uintptr_t offset) {
-                void* rw = reinterpret_cast<void*>(claim.GetAlignedRw() + offset);
-                u64 ro = address;
-
-                R_ABORT_UNLESS(svcUnmapProcessMemory(rw, procHandle, ro, size));
-            }
-        , m_Claim.GetAlignedRo(), m_Claim.GetAlignedSize());
-
-        /* Free RW reservation. */
-        virtmemRemoveReservation(claim.m_RwReserve);
+        ReleaseMapping(*claim.m_Mapping);
     }
 };
@@ -6,14 +6,20 @@
 
 namespace exl::util {
     
+    /* An rw alias of read-only or executable memory. Aliases come from a process-wide pool: a range on pages that are
+       already mapped reuses that mapping, and mappings stay around after their last user is gone until the pool needs
+       the room, so mapping the same pages again is free. */
     class RwPages {
         NON_COPYABLE(RwPages);
+        public:
+            struct Mapping;
+
         private:
             struct Claim {
                 uintptr_t m_Ro = 0;
                 uintptr_t m_Rw = 0;
                 size_t m_Size = 0;
-                VirtmemReservation* m_RwReserve = nullptr;
+                Mapping* m_Mapping = nullptr;
 
                 constexpr uintptr_t GetAlignedRo() const {
                     return ALIGN_DOWN(m_Ro, PAGE_SIZE);
@@ -23,16 +29,17 @@ namespace exl::util {
                     return ALIGN_DOWN(m_Rw, PAGE_SIZE);
                 }
 
+                /* Every page the range touches, from the one it starts in. */
                 constexpr size_t GetAlignedSize() const {
-                    return ALIGN_UP(m_Size, PAGE_SIZE);
+                    return ALIGN_UP(m_Ro + m_Size, PAGE_SIZE) - GetAlignedRo();
                 }
 
                 constexpr ptrdiff_t RoToOffset(uintptr_t address) const {
-                    return m_Ro - address;
+                    return address - m_Ro;
                 }
 
                 constexpr ptrdiff_t RwToOffset(uintptr_t address) const {
-                    return m_Rw - address;
+                    return address - m_Rw;
                 }
 
                 constexpr uintptr_t RoToRw(uintptr_t address) const {
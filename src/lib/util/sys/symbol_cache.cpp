@@ -0,0 +1,165 @@
+#include "symbol_cache.hpp"
+
+#include "build_id.hpp"
+#include "mem_layout.hpp"
+#include "ro.h"
+
+#include <array>
+#include <cstring>
+
+namespace exl::util::symbol_cache {
+
+    namespace {
+        std::array<Entry, MaxEntries> s_Entries;
+        size_t s_EntryCount = 0;
+        bool s_Dirty = false;
+        bool s_Loaded = false;
+        u32 s_HitCount = 0;
+        u32 s_MissCount = 0;
+
+        std::array<BuildId, mem_layout::s_MaxModules> s_BuildIds;
+        std::array<bool, mem_layout::s_MaxModules> s_HasBuildId;
+        bool s_BuildIdsRead = false;
+
+        /* Null for modules without a build ID, their offsets can't be checked against a later boot. */
+        const BuildId* GetBuildId(int index) {
+            if(!s_BuildIdsRead) {
+                for(int i = 0; i < mem_layout::s_ModuleCount; i++)
+                    s_HasBuildId[i] = GetModuleBuildId(&s_BuildIds[i], GetModuleInfo(i));
+                s_BuildIdsRead = true;
+            }
+
+            return s_HasBuildId[index] ? &s_BuildIds[index] : nullptr;
+        }
+
+        const Entry* Find(u64 name_hash) {
+            for(size_t i = 0; i < s_EntryCount; i++) {
+                if(s_Entries[i].m_NameHash == name_hash)
+                    return &s_Entries[i];
+            }
+            return nullptr;
+        }
+
+        void Insert(u64 name_hash, uintptr_t address) {
+            if(s_EntryCount >= MaxEntries)
+                return;
+
+            for(int i = 0; i < mem_layout::s_ModuleCount; i++) {
+                const Range& total = GetModuleInfo(i).m_Total;
+                if(address < total.m_Start || total.GetEnd() <= address)
+                    continue;
+                if(GetBuildId(i) == nullptr)
+                    return;
+
+                s_Entries[s_EntryCount++] = {
+                    .m_NameHash = name_hash,
+                    .m_ModuleIndex = static_cast<u32>(i),
+                    .m_Offset = address - total.m_Start,
+                };
+                s_Dirty = true;
+                return;
+            }
+        }
+    }
+
+    Result Lookup(uintptr_t* out, u64 name_hash, const char* name) {
+        if(const Entry* entry = Find(name_hash); entry != nullptr) {
+            s_HitCount++;
+            *out = GetModuleInfo(entry->m_ModuleIndex).m_Total.m_Start + entry->m_Offset;
+            return result::Success;
+        }
+
+        s_MissCount++;
+        R_TRY(nn::ro::LookupSymbol(out, name));
+
+        Insert(name_hash, *out);
+        return result::Success;
+    }
+
+    bool Load(std::span<const u8> data) {
+        if(data.size() < sizeof(Header))
+            return false;
+
+        Header header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        if(header.m_Magic != Header::Magic || header.m_Version != Header::Version)
+            return false;
+        if(header.m_EntryCount > MaxEntries || data.size() < sizeof(Header) + header.m_EntryCount * sizeof(Entry))
+            return false;
+
+        if(header.m_ModuleCount > mem_layout::s_MaxModules)
+            return false;
+
+        /* Offsets are only meaningful for the exact build they were resolved against, find where each module the cache
+           was written for is loaded now, if it still is. */
+        std::array<int, mem_layout::s_MaxModules> moduleIndices;
+        for(u32 i = 0; i < header.m_ModuleCount; i++) {
+            moduleIndices[i] = -1;
+            for(int current = 0; current < mem_layout::s_ModuleCount; current++) {
+                const BuildId* buildId = GetBuildId(current);
+                if(buildId != nullptr && std::memcmp(header.m_ModuleBuildIds[i], buildId->data(), buildId->size()) == 0) {
+                    moduleIndices[i] = current;
+                    break;
+                }
+            }
+        }
+
+        std::memcpy(s_Entries.data(), data.data() + sizeof(Header), header.m_EntryCount * sizeof(Entry));
+
+        size_t kept = 0;
+        for(size_t i = 0; i < header.m_EntryCount; i++) {
+            Entry& entry = s_Entries[i];
+            if(entry.m_ModuleIndex >= header.m_ModuleCount || moduleIndices[entry.m_ModuleIndex] < 0)
+                continue;
+
+            entry.m_ModuleIndex = moduleIndices[entry.m_ModuleIndex];
+            s_Entries[kept++] = entry;
+        }
+        s_EntryCount = kept;
+
+        s_Dirty = false;
+        s_Loaded = true;
+        return true;
+    }
+
+    bool IsDirty() {
+        return s_Dirty;
+    }
+
+    size_t GetSerializedSize() {
+        return sizeof(Header) + s_EntryCount * sizeof(Entry);
+    }
+
+    size_t Serialize(std::span<u8> out) {
+        size_t size = GetSerializedSize();
+        if(out.size() < size)
+            return 0;
+
+        Header header = {
+            .m_Magic = Header::Magic,
+            .m_Version = Header::Version,
+            .m_EntryCount = static_cast<u32>(s_EntryCount),
+            .m_ModuleCount = static_cast<u32>(mem_layout::s_ModuleCount),
+        };
+
+        for(int i = 0; i < mem_layout::s_ModuleCount; i++) {
+            if(const BuildId* buildId = GetBuildId(i); buildId != nullptr)
+                std::memcpy(header.m_ModuleBuildIds[i], buildId->data(), buildId->size());
+        }
+
+        std::memcpy(out.data(), &header, sizeof(header));
+        std::memcpy(out.data() + sizeof(header), s_Entries.data(), s_EntryCount * sizeof(Entry));
+
+        s_Dirty = false;
+        return size;
+    }
+
+    Stats GetStats() {
+        return {
+            .m_HitCount = s_HitCount,
+            .m_MissCount = s_MissCount,
+            .m_EntryCount = static_cast<u32>(s_EntryCount),
+            .m_Loaded = s_Loaded,
+        };
+    }
+}
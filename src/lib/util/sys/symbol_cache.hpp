@@ -0,0 +1,59 @@
+#pragma once
+
+#include "common.hpp"
+#include "lib/util/hash.hpp"
+#include "mem_layout.hpp"
+
+#include <span>
+
+namespace exl::util::symbol_cache {
+
+    /* Module relative, so entries stay valid across boots despite ASLR. The module index is into the header's build ID
+       table, so entries follow their module when the module list changes and are dropped when the module is rebuilt. */
+    struct Entry {
+        u64 m_NameHash;
+        u32 m_ModuleIndex;
+        u32 m_Reserved;
+        u64 m_Offset;
+    };
+
+    struct Header {
+        static constexpr u32 Magic = 0x43535845; /* EXSC */
+        static constexpr u32 Version = 2;
+
+        u32 m_Magic;
+        u32 m_Version;
+        u32 m_EntryCount;
+        u32 m_ModuleCount;
+        /* All zero for modules without a build ID, which are never cached. */
+        u8 m_ModuleBuildIds[mem_layout::s_MaxModules][0x20];
+    };
+
+    struct Stats {
+        u32 m_HitCount;
+        u32 m_MissCount;
+        u32 m_EntryCount;
+        bool m_Loaded;
+    };
+
+    static constexpr size_t MaxEntries = 256;
+
+    /* Resolves through the cache, falling back to nn::ro::LookupSymbol and remembering the result. */
+    /* Not thread safe, meant for hook installation during startup. */
+    Result Lookup(uintptr_t* out, u64 name_hash, const char* name);
+
+    inline Result Lookup(uintptr_t* out, const char* name) {
+        return Lookup(out, util::HashFnv1a64(name), name);
+    }
+
+    /* Loads a serialized cache. Entries for modules that aren't loaded with the same build ID this boot are dropped. */
+    bool Load(std::span<const u8> data);
+
+    /* True if lookups added entries since the last Load/Serialize. */
+    bool IsDirty();
+
+    size_t GetSerializedSize();
+    size_t Serialize(std::span<u8> out);
+
+    Stats GetStats();
+}
@@ -77,7 +77,7 @@ void Logger::log(const char *fmt, ...) {
         if (ISEMU) {
             svcOutputDebugString(buffer, strlen(buffer));
         } else {
-            nn::socket::Send(instance().mSocketFd, buffer, strlen(buffer), 0);
+            send(buffer);
         }
     }
 
@@ -92,6 +92,17 @@ void Logger::log(const char *fmt, va_list args) {
     char buffer[0x500] = {};
 
     if (nn::util::VSNPrintf(buffer, sizeof(buffer), fmt, args) > 0) {
-        nn::socket::Send(instance().mSocketFd, buffer, strlen(buffer), 0);
+        send(buffer);
     }
 }
+
+void Logger::send(const char *message) {
+    if (SendWrapper wrapper = instance().mSendWrapper)
+        wrapper(sendToSocket, message);
+    else
+        sendToSocket(message);
+}
+
+void Logger::sendToSocket(const char *message) {
+    nn::socket::Send(instance().mSocketFd, message, strlen(message), 0);
+}
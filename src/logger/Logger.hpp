@@ -12,6 +12,9 @@ enum class LoggerState {
 
 class Logger {
 public:
+    // Runs around every message sent to the server, so the mod can time logging without the logger knowing about it.
+    using SendWrapper = void (*)(void (*send)(const char *message), const char *message);
+
     Logger() = default;
 
     static Logger &instance();
@@ -22,8 +25,14 @@ public:
 
     static void log(const char *fmt, va_list args);
 
+    void setSendWrapper(SendWrapper wrapper) { mSendWrapper = wrapper; }
+
 private:
+    static void send(const char *message);
+    static void sendToSocket(const char *message);
+
     LoggerState mState;
     int mSocketFd;
     bool mIsEmulator;
+    SendWrapper mSendWrapper;
 };
\ No newline at end of file
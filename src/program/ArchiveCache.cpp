@@ -0,0 +1,347 @@
+#include "ArchiveCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <nn/fs.h>
+#include <heap/seadExpHeap.h>
+#include <heap/seadHeapMgr.h>
+
+#include "lib.hpp"
+#include "lib/util/hash.hpp"
+#include "logger/Logger.hpp"
+
+namespace {
+    constexpr size_t PREFETCH_STACK_SIZE = 0x4000;
+    constexpr s32 PREFETCH_THREAD_PRIORITY = 20;
+
+    alignas(0x1000) u8 prefetchThreadStack[PREFETCH_STACK_SIZE];
+
+    // matches the path layout used by sead::NinSDFileDevice::formatPathForFS_
+    void formatSdPath(char *out, size_t outSize, const char *path) {
+        snprintf(out, outSize, "sd:/smo/%s", path);
+    }
+
+    struct ScopedLock {
+        explicit ScopedLock(nn::os::MutexType &mutex) : mMutex(mutex) { nn::os::LockMutex(&mMutex); }
+        ~ScopedLock() { nn::os::UnlockMutex(&mMutex); }
+        nn::os::MutexType &mMutex;
+    };
+}
+
+ArchiveCache &ArchiveCache::instance() {
+    static ArchiveCache instance = {};
+    return instance;
+}
+
+void ArchiveCache::init(sead::Heap *parent) {
+    if (isEnabled())
+        return;
+
+    size_t parentFreeSize = parent->getFreeSize();
+    if (parentFreeSize < HEAP_SIZE + PARENT_RESERVE_SIZE) {
+        Logger::log("ArchiveCache: only 0x%lx bytes free on %s, cache disabled\n", parentFreeSize,
+                    parent->getName().cstr());
+        return;
+    }
+
+    sead::ExpHeap *heap = sead::ExpHeap::tryCreate(HEAP_SIZE, "ArchiveCacheHeap", parent, 8,
+                                                   sead::Heap::cHeapDirection_Forward, false);
+    if (!heap) {
+        Logger::log("ArchiveCache: unable to create a 0x%lx byte heap, cache disabled\n", HEAP_SIZE);
+        return;
+    }
+
+    nn::os::InitializeMutex(&m_mutex, false, 0);
+    m_heap = heap;
+
+    loadPrefetchList();
+
+    nn::os::InitializeMessageQueue(&m_prefetchQueue, m_prefetchQueueBuffer, ACNT(m_prefetchQueueBuffer));
+    R_ABORT_UNLESS(nn::os::CreateThread(&m_prefetchThread, prefetchThreadMain, this, prefetchThreadStack,
+                                        PREFETCH_STACK_SIZE, PREFETCH_THREAD_PRIORITY));
+    nn::os::SetThreadName(&m_prefetchThread, "ArchiveCachePrefetch");
+    nn::os::StartThread(&m_prefetchThread);
+
+    // warm up with the start of the route
+    for (int i = 0; i < PREFETCH_DEPTH && i < m_prefetchPathCount; i++)
+        nn::os::TrySendMessageQueue(&m_prefetchQueue, i);
+
+    Logger::log("ArchiveCache: enabled with %d prefetch paths\n", m_prefetchPathCount);
+}
+
+const char *ArchiveCache::stripDrive(const char *path) {
+    // keys never include the drive, so "sd:/ObjectData/A.szs" and "ObjectData/A.szs" match
+    const char *drive = strstr(path, ":/");
+    return drive ? drive + 2 : path;
+}
+
+u32 ArchiveCache::hashPath(const char *path) {
+    return exl::util::HashFnv1a32(stripDrive(path));
+}
+
+ArchiveCache::Entry *ArchiveCache::findEntry(const char *path) {
+    path = stripDrive(path);
+    u32 pathHash = exl::util::HashFnv1a32(path);
+
+    for (Entry &entry : m_entries) {
+        if (entry.data && entry.pathHash == pathHash && strcmp(entry.path, path) == 0)
+            return &entry;
+    }
+    return nullptr;
+}
+
+void ArchiveCache::freeEntry(Entry *entry) {
+    m_heap->free(entry->data);
+    m_usedSize -= entry->size;
+    m_entryCount--;
+    *entry = {};
+}
+
+bool ArchiveCache::evictLeastRecentlyUsed() {
+    Entry *oldest = nullptr;
+    for (Entry &entry : m_entries) {
+        // entries still being filled by the prefetch thread or copied out by a hit can't be evicted
+        if (!entry.data || !entry.isReady || entry.pinCount != 0)
+            continue;
+        if (!oldest || entry.lastUse < oldest->lastUse)
+            oldest = &entry;
+    }
+
+    if (!oldest)
+        return false;
+
+    freeEntry(oldest);
+    return true;
+}
+
+ArchiveCache::Entry *ArchiveCache::allocEntry(const char *path, u32 size) {
+    path = stripDrive(path);
+    if (size == 0 || size > MAX_ENTRY_SIZE || strlen(path) >= MAX_PATH_LENGTH)
+        return nullptr;
+
+    while (m_entryCount >= MAX_ENTRIES) {
+        if (!evictLeastRecentlyUsed())
+            return nullptr;
+    }
+
+    u8 *data = nullptr;
+    while (!(data = (u8 *) m_heap->tryAlloc(size, sead::FileDevice::cBufferMinAlignment))) {
+        if (!evictLeastRecentlyUsed())
+            return nullptr;
+    }
+
+    for (Entry &entry : m_entries) {
+        if (entry.data)
+            continue;
+
+        entry = {
+            .pathHash = exl::util::HashFnv1a32(path),
+            .size = size,
+            .data = data,
+            .lastUse = ++m_useCounter,
+            .pinCount = 0,
+            .isReady = false,
+        };
+        strcpy(entry.path, path);
+        m_entryCount++;
+        m_usedSize += size;
+        return &entry;
+    }
+
+    // unreachable as long as m_entryCount is kept in sync with m_entries
+    m_heap->free(data);
+    return nullptr;
+}
+
+u8 *ArchiveCache::tryLoad(sead::FileDevice::LoadArg &arg) {
+    Entry *entry;
+    u32 bufferSize;
+    {
+        ScopedLock lock(m_mutex);
+
+        entry = findEntry(arg.path.cstr());
+        if (!entry || !entry->isReady) {
+            m_missCount++;
+            return nullptr;
+        }
+
+        bufferSize = entry->size;
+        if (arg.buffer_size_alignment > 0)
+            bufferSize = ALIGN_UP(bufferSize, arg.buffer_size_alignment);
+
+        // the caller is told the buffer holds roundup_size bytes, so that's what has to fit
+        if (arg.buffer && arg.buffer_size < bufferSize) {
+            m_missCount++;
+            return nullptr;
+        }
+
+        // pinned so it can't be evicted while it's copied without the lock
+        entry->pinCount++;
+        entry->lastUse = ++m_useCounter;
+    }
+
+    u8 *buffer = arg.buffer;
+    if (!buffer) {
+        sead::Heap *heap = arg.heap ? arg.heap : sead::HeapMgr::instance()->getCurrentHeap();
+
+        // same alignment rules as sead::FileDevice::doLoad_, negative values allocate from the tail
+        s32 alignment = arg.alignment;
+        if (alignment < 0)
+            alignment = std::min(alignment, -sead::FileDevice::cBufferMinAlignment);
+        else
+            alignment = std::max(alignment, sead::FileDevice::cBufferMinAlignment);
+
+        buffer = (u8 *) heap->tryAlloc(bufferSize, alignment);
+    }
+
+    if (buffer)
+        memcpy(buffer, entry->data, entry->size);
+
+    ScopedLock lock(m_mutex);
+    entry->pinCount--;
+    if (!buffer)
+        return nullptr;
+
+    if (!arg.buffer)
+        arg.need_unload = true;
+    arg.read_size = entry->size;
+    arg.roundup_size = bufferSize;
+    m_hitCount++;
+
+    return buffer;
+}
+
+void ArchiveCache::insert(const sead::SafeString &path, const u8 *data, u32 size) {
+    ScopedLock lock(m_mutex);
+
+    if (findEntry(path.cstr()))
+        return;
+
+    Entry *entry = allocEntry(path.cstr(), size);
+    if (!entry)
+        return;
+
+    memcpy(entry->data, data, size);
+    entry->isReady = true;
+}
+
+void ArchiveCache::requestPrefetchAfter(const sead::SafeString &path) {
+    u32 pathHash = hashPath(path.cstr());
+
+    for (int i = 0; i < m_prefetchPathCount; i++) {
+        if (m_prefetchHashes[i] != pathHash || strcmp(m_prefetchPaths[i], stripDrive(path.cstr())) != 0)
+            continue;
+
+        for (int next = i + 1; next <= i + PREFETCH_DEPTH && next < m_prefetchPathCount; next++)
+            nn::os::TrySendMessageQueue(&m_prefetchQueue, next);
+        return;
+    }
+}
+
+void ArchiveCache::loadPrefetchList() {
+    nn::fs::FileHandle handle;
+    if (nn::fs::OpenFile(&handle, PREFETCH_LIST_PATH, nn::fs::OpenMode_Read).isFailure())
+        return;
+
+    long size = 0;
+    nn::fs::GetFileSize(&size, handle);
+
+    m_prefetchListBuffer = (char *) m_heap->tryAlloc(size + 1, 8);
+    if (!m_prefetchListBuffer || nn::fs::ReadFile(handle, 0, m_prefetchListBuffer, size).isFailure()) {
+        nn::fs::CloseFile(handle);
+        return;
+    }
+    nn::fs::CloseFile(handle);
+    m_prefetchListBuffer[size] = '\0';
+
+    // one archive path per line, relative to sd:/smo/, lines starting with '#' are comments
+    char *line = m_prefetchListBuffer;
+    while (line && *line && m_prefetchPathCount < MAX_PREFETCH_PATHS) {
+        char *next = strchr(line, '\n');
+        if (next)
+            *next++ = '\0';
+
+        size_t length = strlen(line);
+        if (length && line[length - 1] == '\r')
+            line[--length] = '\0';
+
+        if (length && line[0] != '#') {
+            m_prefetchPaths[m_prefetchPathCount] = line;
+            m_prefetchHashes[m_prefetchPathCount] = hashPath(line);
+            m_prefetchPathCount++;
+        }
+
+        line = next;
+    }
+}
+
+void ArchiveCache::prefetch(const char *path) {
+    {
+        ScopedLock lock(m_mutex);
+        if (findEntry(path))
+            return;
+    }
+
+    char fsPath[0x200];
+    formatSdPath(fsPath, sizeof(fsPath), path);
+
+    nn::fs::FileHandle handle;
+    if (nn::fs::OpenFile(&handle, fsPath, nn::fs::OpenMode_Read).isFailure())
+        return;
+
+    long size = 0;
+    nn::fs::GetFileSize(&size, handle);
+
+    Entry *entry;
+    {
+        ScopedLock lock(m_mutex);
+        entry = allocEntry(path, size);
+    }
+
+    if (!entry) {
+        nn::fs::CloseFile(handle);
+        return;
+    }
+
+    // the SD read happens outside the lock so hits on other entries aren't blocked by it
+    bool isSuccess = nn::fs::ReadFile(handle, 0, entry->data, size).isSuccess();
+    nn::fs::CloseFile(handle);
+
+    ScopedLock lock(m_mutex);
+    if (isSuccess)
+        entry->isReady = true;
+    else
+        freeEntry(entry);
+}
+
+void ArchiveCache::prefetchThreadMain(void *arg) {
+    ArchiveCache *cache = (ArchiveCache *) arg;
+
+    while (true) {
+        u64 index = 0;
+        nn::os::ReceiveMessageQueue(&index, &cache->m_prefetchQueue);
+
+        if (index < (u64) cache->m_prefetchPathCount)
+            cache->prefetch(cache->m_prefetchPaths[index]);
+    }
+}
+
+u8 *CachedSDFileDevice::doLoad_(LoadArg &arg) {
+    ArchiveCache &cache = ArchiveCache::instance();
+
+    if (!cache.isEnabled())
+        return NinSDFileDevice::doLoad_(arg);
+
+    cache.requestPrefetchAfter(arg.path);
+
+    if (u8 *data = cache.tryLoad(arg))
+        return data;
+
+    u8 *data = NinSDFileDevice::doLoad_(arg);
+    if (data)
+        cache.insert(arg.path, data, arg.read_size);
+
+    return data;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <nn/os.h>
+
+#include <heap/seadHeap.h>
+#include <filedevice/seadFileDevice.h>
+#include <filedevice/nin/seadNinSDFileDeviceNin.h>
+
+// LRU cache of archives loaded from the SD card. Entries live in a dedicated heap whose size is
+// the cache's byte budget, and are filled either on a miss or by a background prefetch thread
+// that reads ahead through a route list stored on the SD card.
+class ArchiveCache {
+public:
+    static constexpr size_t HEAP_SIZE = 0x1000000;
+    static constexpr u32 MAX_ENTRY_SIZE = HEAP_SIZE / 4;
+    static constexpr int MAX_ENTRIES = 64;
+    static constexpr int MAX_PREFETCH_PATHS = 128;
+    static constexpr int PREFETCH_DEPTH = 2;
+    static constexpr size_t MAX_PATH_LENGTH = 0x100;
+    // left to the game on the parent heap, the cache is disabled rather than starve it
+    static constexpr size_t PARENT_RESERVE_SIZE = 0x400000;
+    static constexpr const char *PREFETCH_LIST_PATH = "sd:/smo/ArchiveCachePrefetch.txt";
+
+    static ArchiveCache &instance();
+
+    void init(sead::Heap *parent);
+
+    bool isEnabled() const { return m_heap != nullptr; }
+
+    // Copies a cached file into the buffer described by arg. Returns nullptr on a miss. The copy is made without
+    // holding the cache's mutex, so other loads and the prefetch thread aren't held up by it.
+    u8 *tryLoad(sead::FileDevice::LoadArg &arg);
+
+    void insert(const sead::SafeString &path, const u8 *data, u32 size);
+
+    // Queues the archives that follow path in the prefetch list.
+    void requestPrefetchAfter(const sead::SafeString &path);
+
+    int getEntryCount() const { return m_entryCount; }
+    size_t getUsedSize() const { return m_usedSize; }
+    u32 getHitCount() const { return m_hitCount; }
+    u32 getMissCount() const { return m_missCount; }
+
+private:
+    struct Entry {
+        // without the drive, compared on a hit so a hash collision can't serve another archive
+        char path[MAX_PATH_LENGTH];
+        u32 pathHash;
+        u32 size;
+        u8 *data;
+        u64 lastUse;
+        // hits copying the data out without holding the mutex
+        u32 pinCount;
+        bool isReady;
+    };
+
+    static void prefetchThreadMain(void *arg);
+
+    static const char *stripDrive(const char *path);
+    static u32 hashPath(const char *path);
+
+    void loadPrefetchList();
+    void prefetch(const char *path);
+
+    Entry *findEntry(const char *path);
+    Entry *allocEntry(const char *path, u32 size);
+    bool evictLeastRecentlyUsed();
+    void freeEntry(Entry *entry);
+
+    sead::Heap *m_heap = nullptr;
+    nn::os::MutexType m_mutex;
+
+    Entry m_entries[MAX_ENTRIES] = {};
+    int m_entryCount = 0;
+    size_t m_usedSize = 0;
+    u64 m_useCounter = 0;
+    u32 m_hitCount = 0;
+    u32 m_missCount = 0;
+
+    char *m_prefetchListBuffer = nullptr;
+    const char *m_prefetchPaths[MAX_PREFETCH_PATHS] = {};
+    u32 m_prefetchHashes[MAX_PREFETCH_PATHS] = {};
+    int m_prefetchPathCount = 0;
+
+    nn::os::ThreadType m_prefetchThread;
+    nn::os::MessageQueueType m_prefetchQueue;
+    u64 m_prefetchQueueBuffer[16];
+};
+
+// SD file device that serves loads out of the ArchiveCache before touching the SD card.
+class CachedSDFileDevice : public sead::NinSDFileDevice {
+protected:
+    u8 *doLoad_(LoadArg &arg) override;
+};
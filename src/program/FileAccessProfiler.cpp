@@ -0,0 +1,267 @@
+#include "FileAccessProfiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <filedevice/seadFileDeviceMgr.h>
+
+#include "imgui.h"
+#include "init.h"
+#include "lib.hpp"
+#include "KoopaFreerunRecorder.hpp"
+#include "logger/Logger.hpp"
+
+namespace {
+    s64 ticksToMicroSeconds(s64 ticks) {
+        return nn::os::ConvertToTimeSpan(nn::os::Tick(ticks)).GetMicroSeconds();
+    }
+}
+
+FileAccessProfiler::Scope::Scope(Op op, const sead::SafeString &path) : m_op(op), m_path(path) {
+    FileAccessProfiler &profiler = FileAccessProfiler::instance();
+
+    // e.g. LoadArchive looking up its device, the outer hook already covers the nested one
+    m_parent = reinterpret_cast<Scope *>(nn::os::GetTlsValue(profiler.m_scopeSlot));
+    m_depth = m_parent ? m_parent->m_depth + 1 : 0;
+    if (!m_parent)
+        m_frameScope.emplace(FrameMonitor::Activity::FileIo);
+
+    nn::os::SetTlsValue(profiler.m_scopeSlot, reinterpret_cast<u64>(this));
+    m_start = nn::os::GetSystemTick();
+}
+
+FileAccessProfiler::Scope::~Scope() {
+    s64 ticks = (nn::os::GetSystemTick() - m_start).GetInt64Value();
+
+    FileAccessProfiler &profiler = FileAccessProfiler::instance();
+    profiler.record(m_op, m_path, m_device, ticks, m_size, m_depth);
+    nn::os::SetTlsValue(profiler.m_scopeSlot, reinterpret_cast<u64>(m_parent));
+}
+
+FileAccessProfiler::FileAccessProfiler() {
+    R_ABORT_UNLESS(nn::os::AllocateTlsSlot(&m_scopeSlot, nullptr));
+}
+
+FileAccessProfiler &FileAccessProfiler::instance() {
+    static FileAccessProfiler instance = {};
+    return instance;
+}
+
+const char *FileAccessProfiler::getOpName(Op op) {
+    switch (op) {
+        case Op::RedirectDevice: return "RedirectDevice";
+        case Op::LoadArchive: return "LoadArchive";
+        case Op::IsExistFile: return "IsExistFile";
+        case Op::IsExistArchive: return "IsExistArchive";
+        default: return "Unknown";
+    }
+}
+
+const char *FileAccessProfiler::getDeviceName(Device device) {
+    switch (device) {
+        case Device::None: return "none";
+        case Device::Sd: return "sd";
+        case Device::Default: return "default";
+        case Device::Other: return "other";
+        default: return "unknown";
+    }
+}
+
+FileAccessProfiler::Device FileAccessProfiler::classifyDevice(sead::FileDevice *device) const {
+    if (!device)
+        return Device::None;
+
+    if (strcmp(device->getDriveName().cstr(), "sd") == 0)
+        return Device::Sd;
+
+    if (device == sead::FileDeviceMgr::instance()->getDefaultFileDevice())
+        return Device::Default;
+
+    return Device::Other;
+}
+
+void FileAccessProfiler::record(Op op, const sead::SafeString &path, sead::FileDevice *device, s64 ticks, u32 size,
+                                u8 depth) {
+    u32 index = m_writeIndex.fetch_add(1, std::memory_order_relaxed);
+    if (index >= MAX_RECORDS) {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // hashed without the drive, so the trace lines up with the ArchiveCache keys
+    const char *relativePath = path.cstr();
+    if (const char *drive = strstr(relativePath, ":/"))
+        relativePath = drive + 2;
+
+    Record &record = m_records[index];
+    record.pathHash = exl::util::HashFnv1a32(relativePath);
+    record.size = size;
+    record.ticks = ticks;
+    record.op = op;
+    record.device = classifyDevice(device);
+    record.depth = depth;
+    record.isCommitted.store(true, std::memory_order_release);
+}
+
+void FileAccessProfiler::reset() {
+    for (Record &record : m_records)
+        record.isCommitted.store(false, std::memory_order_relaxed);
+
+    m_droppedCount.store(0, std::memory_order_relaxed);
+    m_writeIndex.store(0, std::memory_order_release);
+}
+
+u32 FileAccessProfiler::getRecordCount() const {
+    return std::min<u32>(m_writeIndex.load(std::memory_order_acquire), MAX_RECORDS);
+}
+
+bool FileAccessProfiler::exportTrace(const char *path) const {
+    constexpr size_t LINE_SIZE = 64;
+
+    u32 count = getRecordCount();
+    size_t bufferSize = LINE_SIZE * (count + 1);
+    char *buffer = (char *) nn::init::GetAllocator()->Allocate(bufferSize);
+    if (!buffer) {
+        Logger::log("Out of memory, could not export file trace\n");
+        return false;
+    }
+
+    size_t length = 0;
+    appendFormat(buffer, bufferSize, length, "index,op,device,depth,path_hash,size,latency_us\n");
+    for (u32 i = 0; i < count; i++) {
+        const Record &record = m_records[i];
+        if (!record.isCommitted.load(std::memory_order_acquire))
+            continue;
+
+        if (!appendFormat(buffer, bufferSize, length, "%u,%s,%s,%u,%08x,%u,%ld\n", i, getOpName(record.op),
+                          getDeviceName(record.device), record.depth, record.pathHash, record.size,
+                          ticksToMicroSeconds(record.ticks))) {
+            Logger::log("File trace export truncated at record %u\n", i);
+            break;
+        }
+    }
+
+    bool isSuccess = writeFileToPath(buffer, length, path).isSuccess();
+    nn::init::GetAllocator()->Free(buffer);
+
+    return isSuccess;
+}
+
+void FileAccessProfiler::drawWindow() {
+    struct Total {
+        u32 count;
+        s64 ticks;
+        s64 maxTicks;
+    };
+
+    Total opTotals[(int) Op::Count] = {};
+    Total deviceTotals[(int) Device::Count] = {};
+    const Record *slowest[TOP_SLOWEST_COUNT] = {};
+
+    u32 count = getRecordCount();
+    for (u32 i = 0; i < count; i++) {
+        const Record &record = m_records[i];
+        if (!record.isCommitted.load(std::memory_order_acquire))
+            continue;
+
+        Total &opTotal = opTotals[(int) record.op];
+        opTotal.count++;
+        opTotal.ticks += record.ticks;
+        opTotal.maxTicks = std::max(opTotal.maxTicks, record.ticks);
+
+        // nested hooks are already part of the outermost one's time, e.g. LoadArchive covers its RedirectDevice
+        if (record.depth == 0) {
+            Total &deviceTotal = deviceTotals[(int) record.device];
+            deviceTotal.count++;
+            deviceTotal.ticks += record.ticks;
+            deviceTotal.maxTicks = std::max(deviceTotal.maxTicks, record.ticks);
+        }
+
+        // keep the slowest records sorted, slowest first
+        for (int slot = 0; slot < TOP_SLOWEST_COUNT; slot++) {
+            if (slowest[slot] && slowest[slot]->ticks >= record.ticks)
+                continue;
+
+            for (int move = TOP_SLOWEST_COUNT - 1; move > slot; move--)
+                slowest[move] = slowest[move - 1];
+            slowest[slot] = &record;
+            break;
+        }
+    }
+
+    ImGui::Begin("File Access Profiler");
+
+    ImGui::Text("Records: %u / %d (dropped %u)", count, MAX_RECORDS, m_droppedCount.load(std::memory_order_relaxed));
+    if (ImGui::Button("Reset"))
+        reset();
+    ImGui::SameLine();
+    if (ImGui::Button("Export to SD"))
+        exportTrace();
+
+    auto drawTotalRow = [](const char *name, const Total &total) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", name);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", total.count);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", ticksToMicroSeconds(total.ticks) / 1000.f);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", ticksToMicroSeconds(total.maxTicks) / 1000.f);
+    };
+
+    if (ImGui::BeginTable("PerOp", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Hook");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Total ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < (int) Op::Count; i++)
+            drawTotalRow(getOpName((Op) i), opTotals[i]);
+        ImGui::EndTable();
+    }
+
+    if (ImGui::BeginTable("PerDevice", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Device (outermost)");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Total ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < (int) Device::Count; i++)
+            drawTotalRow(getDeviceName((Device) i), deviceTotals[i]);
+        ImGui::EndTable();
+    }
+
+    if (ImGui::BeginTable("Slowest", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Path hash");
+        ImGui::TableSetupColumn("Hook");
+        ImGui::TableSetupColumn("Device");
+        ImGui::TableSetupColumn("Size");
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableHeadersRow();
+        for (const Record *record : slowest) {
+            if (!record)
+                break;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%08x", record->pathHash);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", getOpName(record->op));
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", getDeviceName(record->device));
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", record->size);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ticksToMicroSeconds(record->ticks) / 1000.f);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+void drawFileAccessProfilerWindow() {
+    FileAccessProfiler::instance().drawWindow();
+}
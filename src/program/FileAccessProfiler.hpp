@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+#include <nn/result.h>
+#include <nn/os.h>
+#include <nn/os/os_tick.hpp>
+#include <prim/seadSafeString.h>
+#include <filedevice/seadFileDevice.h>
+
+#include "FrameMonitor.hpp"
+
+// Records every file lookup and load that goes through the SD redirection hooks into a fixed
+// trace buffer. Slots are claimed with a single atomic increment, so the hooks can record from
+// the loading threads without taking a lock.
+class FileAccessProfiler {
+public:
+    enum class Op : u8 {
+        RedirectDevice,
+        LoadArchive,
+        IsExistFile,
+        IsExistArchive,
+        Count
+    };
+
+    enum class Device : u8 {
+        None,
+        Sd,
+        Default,
+        Other,
+        Count
+    };
+
+    struct Record {
+        u32 pathHash;
+        u32 size;
+        s64 ticks;
+        Op op;
+        Device device;
+        // hooks open around this one on the same thread, 0 for the outermost
+        u8 depth;
+        std::atomic<bool> isCommitted;
+    };
+
+    // Times a hook from construction to destruction. Only the outermost hook on a thread is charged to the frame
+    // monitor, the ones it calls into are already part of its time.
+    class Scope {
+    public:
+        Scope(Op op, const sead::SafeString &path);
+        ~Scope();
+
+        void setDevice(sead::FileDevice *device) { m_device = device; }
+        void setSize(u32 size) { m_size = size; }
+
+    private:
+        Op m_op;
+        const sead::SafeString &m_path;
+        sead::FileDevice *m_device = nullptr;
+        u32 m_size = 0;
+        nn::os::Tick m_start;
+        Scope *m_parent;
+        u8 m_depth;
+        std::optional<FrameMonitor::Scope> m_frameScope;
+    };
+
+    static constexpr int MAX_RECORDS = 4096;
+    static constexpr int TOP_SLOWEST_COUNT = 10;
+    static constexpr const char *TRACE_PATH = "sd:/koopafreerun_filetrace.csv";
+
+    static FileAccessProfiler &instance();
+
+    void record(Op op, const sead::SafeString &path, sead::FileDevice *device, s64 ticks, u32 size, u8 depth);
+
+    // Starts a new trace. Not synchronized with writers, records in flight may be lost.
+    void reset();
+
+    bool exportTrace(const char *path = TRACE_PATH) const;
+
+    void drawWindow();
+
+    static const char *getOpName(Op op);
+    static const char *getDeviceName(Device device);
+
+private:
+    FileAccessProfiler();
+
+    Device classifyDevice(sead::FileDevice *device) const;
+
+    u32 getRecordCount() const;
+
+    Record m_records[MAX_RECORDS];
+    std::atomic<u32> m_writeIndex = 0;
+    std::atomic<u32> m_droppedCount = 0;
+    // innermost open scope of each thread
+    nn::os::TlsSlot m_scopeSlot = {};
+};
+
+void drawFileAccessProfilerWindow();
@@ -0,0 +1,206 @@
+#include "FrameMonitor.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "imgui.h"
+#include "lib.hpp"
+#include "logger/Logger.hpp"
+
+namespace {
+    float ticksToMilliSeconds(s64 ticks) {
+        return nn::os::ConvertToTimeSpan(nn::os::Tick(ticks)).GetMicroSeconds() / 1000.f;
+    }
+
+    // scratch for the window, only touched from the draw thread
+    float frameTimes[FrameMonitor::FRAME_COUNT];
+    float sortedFrameTimes[FrameMonitor::FRAME_COUNT];
+
+    float getPercentile(float *values, int count, float percentile) {
+        int index = std::min<int>(count * percentile, count - 1);
+        std::nth_element(values, values + index, values + count);
+        return values[index];
+    }
+
+    void timeLoggerSend(void (*send)(const char *message), const char *message) {
+        FrameMonitor::Scope scope(FrameMonitor::Activity::Logger);
+        send(message);
+    }
+}
+
+FrameMonitor::Scope::Scope(Activity activity) : m_activity(activity) {
+    FrameMonitor &monitor = FrameMonitor::instance();
+    nn::os::Tick now = nn::os::GetSystemTick();
+
+    // the enclosing scope is charged up to here and picks up again once this one ends
+    m_parent = reinterpret_cast<Scope *>(nn::os::GetTlsValue(monitor.m_scopeSlot));
+    if (m_parent)
+        monitor.addActivity(m_parent->m_activity, (now - m_parent->m_start).GetInt64Value());
+
+    m_start = now;
+    nn::os::SetTlsValue(monitor.m_scopeSlot, reinterpret_cast<u64>(this));
+}
+
+FrameMonitor::Scope::~Scope() {
+    FrameMonitor &monitor = FrameMonitor::instance();
+    nn::os::Tick now = nn::os::GetSystemTick();
+
+    monitor.addActivity(m_activity, (now - m_start).GetInt64Value());
+    if (m_parent)
+        m_parent->m_start = now;
+
+    nn::os::SetTlsValue(monitor.m_scopeSlot, reinterpret_cast<u64>(m_parent));
+}
+
+FrameMonitor::FrameMonitor() {
+    R_ABORT_UNLESS(nn::os::AllocateTlsSlot(&m_scopeSlot, nullptr));
+    Logger::instance().setSendWrapper(timeLoggerSend);
+}
+
+FrameMonitor &FrameMonitor::instance() {
+    static FrameMonitor instance = {};
+    return instance;
+}
+
+const char *FrameMonitor::getActivityName(Activity activity) {
+    switch (activity) {
+        case Activity::Recorder: return "Recorder";
+        case Activity::Logger: return "Logger";
+        case Activity::FileIo: return "File I/O";
+        default: return "Game";
+    }
+}
+
+void FrameMonitor::addActivity(Activity activity, s64 ticks) {
+    m_pendingActivityTicks[(int) activity].fetch_add(ticks, std::memory_order_relaxed);
+}
+
+void FrameMonitor::onControlBegin() {
+    nn::os::Tick now = nn::os::GetSystemTick();
+    m_currentIntervalTicks = m_hasControlBegin ? (now - m_controlBegin).GetInt64Value() : 0;
+    m_controlBegin = now;
+    m_hasControlBegin = true;
+}
+
+void FrameMonitor::onControlEnd() {
+    s64 controlTicks = (nn::os::GetSystemTick() - m_controlBegin).GetInt64Value();
+
+    // activity is charged to the frame it ends in, whichever thread it ran on
+    Frame frame = {.intervalTicks = m_currentIntervalTicks, .controlTicks = controlTicks};
+    for (int i = 0; i < (int) Activity::Count; i++)
+        frame.activityTicks[i] = m_pendingActivityTicks[i].exchange(0, std::memory_order_relaxed);
+
+    if (m_currentIntervalTicks == 0 ||
+        nn::os::ConvertToTimeSpan(nn::os::Tick(m_currentIntervalTicks)).GetMilliSeconds() >= GAP_MS)
+        return;
+
+    u32 index = m_frameCount.load(std::memory_order_relaxed);
+    m_frames[index % FRAME_COUNT] = frame;
+    m_frameCount.store(index + 1, std::memory_order_release);
+
+    if (ticksToMilliSeconds(frame.intervalTicks) > m_budgetMs)
+        recordHitch(index, frame);
+}
+
+void FrameMonitor::recordHitch(u32 frameIndex, const Frame &frame) {
+    // put down to the activity that took longest, as long as it's a noticeable share of the frame
+    Activity cause = Activity::Count;
+    s64 causeTicks = 0;
+    for (int i = 0; i < (int) Activity::Count; i++) {
+        if (frame.activityTicks[i] > causeTicks) {
+            cause = (Activity) i;
+            causeTicks = frame.activityTicks[i];
+        }
+    }
+    if (causeTicks * 10 < frame.intervalTicks) {
+        cause = Activity::Count;
+        causeTicks = 0;
+    }
+
+    u32 index = m_hitchCount.load(std::memory_order_relaxed);
+    m_hitches[index % HITCH_COUNT] = {
+        .frameIndex = frameIndex,
+        .intervalTicks = frame.intervalTicks,
+        .cause = cause,
+        .causeTicks = causeTicks,
+    };
+    m_hitchCauseCounts[(int) cause]++;
+    m_hitchCount.store(index + 1, std::memory_order_release);
+}
+
+void FrameMonitor::drawWindow() {
+    ImGui::Begin("Frame Pacing");
+
+    ImGui::Checkbox("Enabled", &m_isEnabled);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderFloat("Budget ms", &m_budgetMs, 16.7f, 100.f, "%.1f");
+
+    u32 frameCount = m_frameCount.load(std::memory_order_acquire);
+    int count = std::min<u32>(frameCount, FRAME_COUNT);
+    if (count == 0) {
+        ImGui::Text("No frames yet");
+        ImGui::End();
+        return;
+    }
+
+    // oldest first, so the graph scrolls to the left
+    for (int i = 0; i < count; i++) {
+        const Frame &frame = m_frames[(frameCount - count + i) % FRAME_COUNT];
+        frameTimes[i] = ticksToMilliSeconds(frame.intervalTicks);
+    }
+    std::copy(frameTimes, frameTimes + count, sortedFrameTimes);
+
+    float p50 = getPercentile(sortedFrameTimes, count, 0.50f);
+    float p95 = getPercentile(sortedFrameTimes, count, 0.95f);
+    float p99 = getPercentile(sortedFrameTimes, count, 0.99f);
+    float max = *std::max_element(frameTimes, frameTimes + count);
+
+    char overlay[0x60];
+    snprintf(overlay, sizeof(overlay), "p50 %.1f  p95 %.1f  p99 %.1f  max %.1f ms", p50, p95, p99, max);
+    ImGui::PlotLines("##FrameTimes", frameTimes, count, 0, overlay, 0.f, std::max(m_budgetMs * 2, p99),
+                     ImVec2(-1, 60));
+
+    const Frame &last = m_frames[(frameCount - 1) % FRAME_COUNT];
+    ImGui::Text("Control %.2f ms, recorder %.2f, logger %.2f, file I/O %.2f", ticksToMilliSeconds(last.controlTicks),
+                ticksToMilliSeconds(last.activityTicks[(int) Activity::Recorder]),
+                ticksToMilliSeconds(last.activityTicks[(int) Activity::Logger]),
+                ticksToMilliSeconds(last.activityTicks[(int) Activity::FileIo]));
+
+    u32 hitchCount = m_hitchCount.load(std::memory_order_acquire);
+    ImGui::Text("Hitches: %u", hitchCount);
+    for (int i = 0; i <= (int) Activity::Count; i++) {
+        ImGui::SameLine();
+        ImGui::Text("%s %u", getActivityName((Activity) i), m_hitchCauseCounts[i]);
+    }
+
+    if (hitchCount != 0 && ImGui::BeginTable("Hitches", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Frame");
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableSetupColumn("Cause");
+        ImGui::TableSetupColumn("Cause ms");
+        ImGui::TableHeadersRow();
+
+        // newest first
+        for (u32 i = 0; i < std::min<u32>(hitchCount, HITCH_COUNT); i++) {
+            const Hitch &hitch = m_hitches[(hitchCount - 1 - i) % HITCH_COUNT];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", hitch.frameIndex);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ticksToMilliSeconds(hitch.intervalTicks));
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", getActivityName(hitch.cause));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ticksToMilliSeconds(hitch.causeTicks));
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+void drawFrameMonitorWindow() {
+    FrameMonitor::instance().drawWindow();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+
+#include <nn/result.h>
+#include <nn/os.h>
+#include <nn/os/os_tick.hpp>
+
+// Times every StageScene::control call from the control hook into a fixed ring of frames, and flags frames that
+// took longer than the budget. Work the mod does on the side (recording, logging, file access) is timed with Scope
+// from whichever thread runs it and charged to the frame it happened in, so a hitch can be put down to it.
+class FrameMonitor {
+public:
+    enum class Activity : u8 {
+        Recorder,
+        Logger,
+        FileIo,
+        Count
+    };
+
+    // Times an activity from construction to destruction. A scope opened inside another one on the same thread pauses
+    // it, so time is only ever charged to the innermost activity.
+    class Scope {
+    public:
+        explicit Scope(Activity activity);
+        ~Scope();
+
+    private:
+        Activity m_activity;
+        nn::os::Tick m_start;
+        Scope *m_parent;
+    };
+
+    struct Frame {
+        // from the start of the previous control call to the start of this one
+        s64 intervalTicks;
+        s64 controlTicks;
+        s64 activityTicks[(int) Activity::Count];
+    };
+
+    struct Hitch {
+        u32 frameIndex;
+        s64 intervalTicks;
+        // Activity::Count when none of the tracked activities ran in the frame
+        Activity cause;
+        s64 causeTicks;
+    };
+
+    static constexpr int FRAME_COUNT = 512;
+    static constexpr int HITCH_COUNT = 16;
+    // a frame dropped at 60 fps
+    static constexpr float DEFAULT_BUDGET_MS = 25.f;
+    // anything longer is the game not running the scene (loading, pausing the hook), not a hitch
+    static constexpr s64 GAP_MS = 500;
+
+    static FrameMonitor &instance();
+
+    bool isEnabled() const { return m_isEnabled; }
+    void setEnabled(bool isEnabled) { m_isEnabled = isEnabled; }
+
+    void onControlBegin();
+    void onControlEnd();
+
+    void addActivity(Activity activity, s64 ticks);
+
+    void drawWindow();
+
+    static const char *getActivityName(Activity activity);
+
+private:
+    FrameMonitor();
+
+    void recordHitch(u32 frameIndex, const Frame &frame);
+
+    bool m_isEnabled = true;
+    float m_budgetMs = DEFAULT_BUDGET_MS;
+
+    // written by the control hook, read by the window without a lock
+    Frame m_frames[FRAME_COUNT] = {};
+    std::atomic<u32> m_frameCount = 0;
+    Hitch m_hitches[HITCH_COUNT] = {};
+    std::atomic<u32> m_hitchCount = 0;
+    u32 m_hitchCauseCounts[(int) Activity::Count + 1] = {};
+
+    std::atomic<s64> m_pendingActivityTicks[(int) Activity::Count] = {};
+    // innermost open scope of each thread
+    nn::os::TlsSlot m_scopeSlot = {};
+    nn::os::Tick m_controlBegin;
+    s64 m_currentIntervalTicks = 0;
+    bool m_hasControlBegin = false;
+};
+
+void drawFrameMonitorWindow();
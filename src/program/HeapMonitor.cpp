@@ -0,0 +1,343 @@
+#include "HeapMonitor.hpp"
+
+#include <cstdio>
+
+#include <al/Library/Memory/HeapUtil.h>
+#include <heap/seadExpHeap.h>
+#include <heap/seadFrameHeap.h>
+#include <heap/seadMemBlock.h>
+#include <nn/os/os_tick.hpp>
+
+#include "imgui.h"
+#include "lib.hpp"
+
+namespace {
+    struct NamedHeap {
+        const char *name;
+        sead::Heap *(*get)();
+    };
+
+    constexpr NamedHeap NAMED_HEAPS[HeapMonitor::WATCHED_HEAP_COUNT] = {
+        {"Stationed", al::getStationedHeap},
+        {"Sequence", al::getSequenceHeap},
+        {"Scene", al::getSceneHeap},
+        {"SceneResource", al::getSceneResourceHeap},
+        {"WorldResource", al::getWorldResourceHeap},
+        {"CourseSelect", al::getCourseSelectHeap},
+        {"CourseSelectResource", al::getCourseSelectResourceHeap},
+    };
+
+    // largest free block is walked from the free list, so it's only refreshed this often
+    constexpr int LARGEST_FREE_INTERVAL_FRAMES = 30;
+    constexpr s64 RATE_WINDOW_MS = 1000;
+
+    // ExpHeap puts a MemBlock right in front of every allocation, holding the size of the block after it.
+    struct MemBlockView : sead::MemBlock {
+        static size_t getSize(const void *ptr) {
+            auto block = reinterpret_cast<const MemBlockView *>(reinterpret_cast<uintptr_t>(ptr) - sizeof(sead::MemBlock));
+            return block->mSize;
+        }
+    };
+
+    struct HeapWindowState {
+        size_t largestFree;
+        u64 lastAllocatedBytes;
+        u64 lastAllocCount;
+        float bytesPerSecond;
+        float allocsPerSecond;
+    };
+
+    HeapWindowState windowStates[HeapMonitor::WATCHED_HEAP_COUNT] = {};
+    nn::os::Tick lastRateTick;
+    int lastLargestFreeFrame = -LARGEST_FREE_INTERVAL_FRAMES;
+
+    void syncHeap(sead::Heap *heap) {
+        HeapMonitor &monitor = HeapMonitor::instance();
+        if (HeapMonitor::HeapStats *stats = monitor.findStats(heap))
+            monitor.syncLiveBytes(*stats, heap);
+    }
+
+    void formatBytes(char *out, size_t outSize, s64 bytes) {
+        if (bytes >= 1024 * 1024 || bytes <= -1024 * 1024)
+            snprintf(out, outSize, "%.2f MiB", bytes / (1024.f * 1024.f));
+        else
+            snprintf(out, outSize, "%.1f KiB", bytes / 1024.f);
+    }
+}
+
+HOOK_DEFINE_TRAMPOLINE(ExpHeapTryAlloc) {
+    static void *Callback(sead::ExpHeap *thisPtr, size_t size, s32 alignment) {
+        void *ptr = Orig(thisPtr, size, alignment);
+
+        HeapMonitor &monitor = HeapMonitor::instance();
+        if (HeapMonitor::HeapStats *stats = monitor.findStats(thisPtr)) {
+            if (ptr)
+                monitor.onAlloc(*stats, MemBlockView::getSize(ptr));
+            else
+                monitor.onAllocFailed(*stats);
+        }
+
+        return ptr;
+    }
+};
+
+HOOK_DEFINE_TRAMPOLINE(ExpHeapFree) {
+    static void Callback(sead::ExpHeap *thisPtr, void *ptr) {
+        HeapMonitor &monitor = HeapMonitor::instance();
+        if (ptr) {
+            if (HeapMonitor::HeapStats *stats = monitor.findStats(thisPtr))
+                monitor.onFree(*stats, MemBlockView::getSize(ptr));
+        }
+
+        Orig(thisPtr, ptr);
+    }
+};
+
+HOOK_DEFINE_TRAMPOLINE(ExpHeapFreeAll) {
+    static void Callback(sead::ExpHeap *thisPtr) {
+        Orig(thisPtr);
+        syncHeap(thisPtr);
+    }
+};
+
+// resizing moves bytes between a block and its neighbours, and reallocating may or may not go through the
+// hooked tryAlloc and free, so the live size is taken from the heap again afterwards
+HOOK_DEFINE_TRAMPOLINE(ExpHeapTryRealloc) {
+    static void *Callback(sead::ExpHeap *thisPtr, void *ptr, size_t size, s32 alignment) {
+        void *result = Orig(thisPtr, ptr, size, alignment);
+        syncHeap(thisPtr);
+        return result;
+    }
+};
+
+HOOK_DEFINE_TRAMPOLINE(ExpHeapResizeFront) {
+    static void *Callback(sead::ExpHeap *thisPtr, void *ptr, size_t size) {
+        void *result = Orig(thisPtr, ptr, size);
+        syncHeap(thisPtr);
+        return result;
+    }
+};
+
+HOOK_DEFINE_TRAMPOLINE(ExpHeapResizeBack) {
+    static void *Callback(sead::ExpHeap *thisPtr, void *ptr, size_t size) {
+        void *result = Orig(thisPtr, ptr, size);
+        syncHeap(thisPtr);
+        return result;
+    }
+};
+
+HOOK_DEFINE_TRAMPOLINE(FrameHeapTryAlloc) {
+    static void *Callback(sead::FrameHeap *thisPtr, size_t size, s32 alignment) {
+        void *ptr = Orig(thisPtr, size, alignment);
+
+        HeapMonitor &monitor = HeapMonitor::instance();
+        if (HeapMonitor::HeapStats *stats = monitor.findStats(thisPtr)) {
+            if (ptr) {
+                monitor.onAlloc(*stats, size);
+                monitor.syncLiveBytes(*stats, thisPtr);
+            } else {
+                monitor.onAllocFailed(*stats);
+            }
+        }
+
+        return ptr;
+    }
+};
+
+// frame heaps only free in bulk, so the live size is taken from the heap again afterwards
+HOOK_DEFINE_TRAMPOLINE(FrameHeapFreeAll) {
+    static void Callback(sead::FrameHeap *thisPtr) {
+        Orig(thisPtr);
+        syncHeap(thisPtr);
+    }
+};
+
+HOOK_DEFINE_TRAMPOLINE(FrameHeapFreeHead) {
+    static void Callback(sead::FrameHeap *thisPtr) {
+        Orig(thisPtr);
+        syncHeap(thisPtr);
+    }
+};
+
+HOOK_DEFINE_TRAMPOLINE(FrameHeapFreeTail) {
+    static void Callback(sead::FrameHeap *thisPtr) {
+        Orig(thisPtr);
+        syncHeap(thisPtr);
+    }
+};
+
+HeapMonitor &HeapMonitor::instance() {
+    static HeapMonitor instance = {};
+    return instance;
+}
+
+void HeapMonitor::installHooks() {
+    ExpHeapTryAlloc::InstallAtSymbol("_ZN4sead7ExpHeap8tryAllocEmi");
+    ExpHeapFree::InstallAtSymbol("_ZN4sead7ExpHeap4freeEPv");
+    ExpHeapFreeAll::InstallAtSymbol("_ZN4sead7ExpHeap7freeAllEv");
+    ExpHeapTryRealloc::InstallAtSymbol("_ZN4sead7ExpHeap10tryReallocEPvmi");
+    ExpHeapResizeFront::InstallAtSymbol("_ZN4sead7ExpHeap11resizeFrontEPvm");
+    ExpHeapResizeBack::InstallAtSymbol("_ZN4sead7ExpHeap10resizeBackEPvm");
+    FrameHeapTryAlloc::InstallAtSymbol("_ZN4sead9FrameHeap8tryAllocEmi");
+    FrameHeapFreeAll::InstallAtSymbol("_ZN4sead9FrameHeap7freeAllEv");
+    FrameHeapFreeHead::InstallAtSymbol("_ZN4sead9FrameHeap8freeHeadEv");
+    FrameHeapFreeTail::InstallAtSymbol("_ZN4sead9FrameHeap8freeTailEv");
+}
+
+void HeapMonitor::refreshHeaps() {
+    for (int i = 0; i < WATCHED_HEAP_COUNT; i++) {
+        HeapStats &stats = m_heaps[i];
+        stats.name = NAMED_HEAPS[i].name;
+
+        sead::Heap *heap = NAMED_HEAPS[i].get();
+        if (heap == stats.heap.load(std::memory_order_relaxed))
+            continue;
+
+        // hooks stop matching the old heap first, so nothing is counted against the reset values twice
+        stats.heap.store(nullptr, std::memory_order_relaxed);
+        stats.allocatedBytes.store(0, std::memory_order_relaxed);
+        stats.allocCount.store(0, std::memory_order_relaxed);
+        stats.freeCount.store(0, std::memory_order_relaxed);
+        stats.failCount.store(0, std::memory_order_relaxed);
+        stats.peakLiveBytes.store(0, std::memory_order_relaxed);
+        windowStates[i] = {};
+
+        // whatever was allocated before the heap was watched counts as live
+        if (heap)
+            syncLiveBytes(stats, heap);
+        else
+            stats.liveBytes.store(0, std::memory_order_relaxed);
+
+        stats.heap.store(heap, std::memory_order_release);
+    }
+}
+
+HeapMonitor::HeapStats *HeapMonitor::findStats(const sead::Heap *heap) {
+    for (HeapStats &stats : m_heaps) {
+        if (stats.heap.load(std::memory_order_relaxed) == heap)
+            return &stats;
+    }
+    return nullptr;
+}
+
+void HeapMonitor::onAlloc(HeapStats &stats, size_t size) {
+    stats.allocCount.fetch_add(1, std::memory_order_relaxed);
+    stats.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (size == 0)
+        return;
+
+    s64 live = stats.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    s64 peak = stats.peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !stats.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+}
+
+void HeapMonitor::onFree(HeapStats &stats, size_t size) {
+    stats.freeCount.fetch_add(1, std::memory_order_relaxed);
+    stats.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void HeapMonitor::onAllocFailed(HeapStats &stats) {
+    stats.failCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void HeapMonitor::syncLiveBytes(HeapStats &stats, sead::Heap *heap) {
+    s64 live = heap->getSize() - heap->getFreeSize();
+    stats.liveBytes.store(live, std::memory_order_relaxed);
+
+    s64 peak = stats.peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !stats.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+}
+
+void HeapMonitor::drawWindow() {
+    refreshHeaps();
+
+    if (!ImGui::Begin("Sead Heaps")) {
+        ImGui::End();
+        return;
+    }
+
+    bool isLargestFreeDue = ImGui::GetFrameCount() - lastLargestFreeFrame >= LARGEST_FREE_INTERVAL_FRAMES;
+    if (isLargestFreeDue)
+        lastLargestFreeFrame = ImGui::GetFrameCount();
+
+    nn::os::Tick now = nn::os::GetSystemTick();
+    s64 elapsedMs = nn::os::ConvertToTimeSpan(now - lastRateTick).GetMilliSeconds();
+    bool isRateDue = elapsedMs >= RATE_WINDOW_MS;
+    if (isRateDue)
+        lastRateTick = now;
+
+    if (ImGui::BeginTable("Heaps", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Heap");
+        ImGui::TableSetupColumn("Usage");
+        ImGui::TableSetupColumn("Peak");
+        ImGui::TableSetupColumn("Largest free");
+        ImGui::TableSetupColumn("Allocs/s");
+        ImGui::TableSetupColumn("Alloc rate");
+        ImGui::TableSetupColumn("Failed");
+        ImGui::TableHeadersRow();
+
+        for (int i = 0; i < WATCHED_HEAP_COUNT; i++) {
+            HeapStats &stats = m_heaps[i];
+            HeapWindowState &state = windowStates[i];
+            sead::Heap *heap = stats.heap.load(std::memory_order_acquire);
+            if (!heap)
+                continue;
+
+            u64 allocatedBytes = stats.allocatedBytes.load(std::memory_order_relaxed);
+            u64 allocCount = stats.allocCount.load(std::memory_order_relaxed);
+            if (isRateDue) {
+                state.bytesPerSecond = (allocatedBytes - state.lastAllocatedBytes) * 1000.f / elapsedMs;
+                state.allocsPerSecond = (allocCount - state.lastAllocCount) * 1000.f / elapsedMs;
+                state.lastAllocatedBytes = allocatedBytes;
+                state.lastAllocCount = allocCount;
+            }
+            if (isLargestFreeDue)
+                state.largestFree = heap->getMaxAllocatableSize(sizeof(void *));
+
+            size_t size = heap->getSize();
+            s64 live = stats.liveBytes.load(std::memory_order_relaxed);
+            char text[0x40];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", stats.name);
+
+            ImGui::TableNextColumn();
+            char liveText[0x20], sizeText[0x20];
+            formatBytes(liveText, sizeof(liveText), live);
+            formatBytes(sizeText, sizeof(sizeText), size);
+            snprintf(text, sizeof(text), "%s / %s", liveText, sizeText);
+            ImGui::ProgressBar(size == 0 ? 0.f : (float) live / size, ImVec2(-1, 0), text);
+
+            ImGui::TableNextColumn();
+            formatBytes(text, sizeof(text), stats.peakLiveBytes.load(std::memory_order_relaxed));
+            ImGui::Text("%s", text);
+
+            ImGui::TableNextColumn();
+            formatBytes(text, sizeof(text), state.largestFree);
+            ImGui::Text("%s", text);
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", state.allocsPerSecond);
+
+            ImGui::TableNextColumn();
+            formatBytes(text, sizeof(text), state.bytesPerSecond);
+            ImGui::Text("%s/s", text);
+
+            ImGui::TableNextColumn();
+            u64 failCount = stats.failCount.load(std::memory_order_relaxed);
+            if (failCount != 0)
+                ImGui::TextColored(ImVec4(1.f, 0.3f, 0.3f, 1.f), "%lu", failCount);
+            else
+                ImGui::Text("0");
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+void drawHeapMonitorWindow() {
+    HeapMonitor::instance().drawWindow();
+}
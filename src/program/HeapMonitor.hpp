@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+#include <heap/seadHeap.h>
+
+// Tracks the game's named sead heaps through hooks on ExpHeap and FrameHeap. Only the heaps in the watch list are
+// counted, so the allocation hooks stay a handful of pointer compares for every other heap. Counters are atomics
+// updated from whichever thread allocates, the window reads them without a lock.
+class HeapMonitor {
+public:
+    struct HeapStats {
+        const char *name;
+        std::atomic<sead::Heap *> heap;
+        std::atomic<s64> liveBytes;
+        std::atomic<s64> peakLiveBytes;
+        std::atomic<u64> allocatedBytes;
+        std::atomic<u64> allocCount;
+        std::atomic<u64> freeCount;
+        std::atomic<u64> failCount;
+    };
+
+    static constexpr int WATCHED_HEAP_COUNT = 7;
+
+    static HeapMonitor &instance();
+
+    static void installHooks();
+
+    // Picks up heaps that were created or replaced since the last call, which resets their counters.
+    void refreshHeaps();
+
+    HeapStats *findStats(const sead::Heap *heap);
+
+    void onAlloc(HeapStats &stats, size_t size);
+    void onFree(HeapStats &stats, size_t size);
+    void onAllocFailed(HeapStats &stats);
+    // For heaps whose allocations can't be sized on free, takes the live size from the heap itself.
+    void syncLiveBytes(HeapStats &stats, sead::Heap *heap);
+
+    void drawWindow();
+
+private:
+    HeapStats m_heaps[WATCHED_HEAP_COUNT] = {};
+};
+
+void drawHeapMonitorWindow();
@@ -0,0 +1,139 @@
+#include "HookProfilerWindow.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+
+#include "imgui.h"
+#include "init.h"
+#include "lib.hpp"
+#include "KoopaFreerunRecorder.hpp"
+#include "logger/Logger.hpp"
+
+namespace {
+    int resetFrame = 0;
+
+    float ticksToMicroSeconds(u64 ticks) {
+        return ticks * 1000000.f / exl::hook::GetCounterFrequency();
+    }
+}
+
+bool exportHookProfiles(const char *path) {
+    constexpr size_t LINE_SIZE = 0x200;
+
+    auto profiles = exl::hook::GetProfiles();
+    size_t bufferSize = LINE_SIZE * (profiles.size() + 1);
+    char *buffer = (char *) nn::init::GetAllocator()->Allocate(bufferSize);
+    if (!buffer) {
+        Logger::log("Out of memory, could not export hook profiles\n");
+        return false;
+    }
+
+    // per call columns and the histogram include the original function, the self columns don't
+    size_t length = 0;
+    appendFormat(buffer, bufferSize, length, "name,count,self_total_us,self_avg_us,total_us,min_us,avg_us,max_us");
+    for (size_t bucket = 0; bucket < exl::hook::HookProfile::HistogramBucketCount; bucket++)
+        appendFormat(buffer, bufferSize, length, ",bucket_%zu", bucket);
+    appendFormat(buffer, bufferSize, length, "\n");
+
+    for (const exl::hook::HookProfile *profile : profiles) {
+        if (!profile)
+            continue;
+
+        size_t lineStart = length;
+        bool isWritten = appendFormat(buffer, bufferSize, length, "%s,%lu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f",
+                                      profile->GetName(), profile->GetCount(),
+                                      ticksToMicroSeconds(profile->GetSelfTicks()),
+                                      ticksToMicroSeconds(profile->GetAverageSelfTicks()),
+                                      ticksToMicroSeconds(profile->GetTotalTicks()),
+                                      ticksToMicroSeconds(profile->GetMinTicks()),
+                                      ticksToMicroSeconds(profile->GetAverageTicks()),
+                                      ticksToMicroSeconds(profile->GetMaxTicks()));
+        for (size_t bucket = 0; bucket < exl::hook::HookProfile::HistogramBucketCount && isWritten; bucket++)
+            isWritten = appendFormat(buffer, bufferSize, length, ",%lu", profile->GetHistogramBucket(bucket));
+        if (!isWritten || !appendFormat(buffer, bufferSize, length, "\n")) {
+            // drop the partial row
+            length = lineStart;
+            break;
+        }
+    }
+
+    bool isSuccess = writeFileToPath(buffer, length, path).isSuccess();
+    nn::init::GetAllocator()->Free(buffer);
+
+    return isSuccess;
+}
+
+void drawHookProfilerWindow() {
+    auto profiles = exl::hook::GetProfiles();
+
+    // the draw functions run once per presented frame
+    int frameCount = std::max(ImGui::GetFrameCount() - resetFrame, 1);
+
+    ImGui::Begin("Hook Profiler");
+
+    ImGui::Text("Frames: %d", frameCount);
+    if (ImGui::Button("Reset")) {
+        for (exl::hook::HookProfile *profile : profiles) {
+            if (profile)
+                profile->Reset();
+        }
+        resetFrame = ImGui::GetFrameCount();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export to SD"))
+        exportHookProfiles();
+
+    // self time leaves out the hooked function, min/max can only be taken per call and include it
+    if (ImGui::BeginTable("Hooks", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Hook");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Calls/frame");
+        ImGui::TableSetupColumn("Self avg us");
+        ImGui::TableSetupColumn("Self us/frame");
+        ImGui::TableSetupColumn("Incl. min us");
+        ImGui::TableSetupColumn("Incl. avg us");
+        ImGui::TableSetupColumn("Incl. max us");
+        ImGui::TableHeadersRow();
+
+        for (const exl::hook::HookProfile *profile : profiles) {
+            if (!profile)
+                continue;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", profile->GetName());
+            ImGui::TableNextColumn();
+            ImGui::Text("%lu", profile->GetCount());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", (float) profile->GetCount() / frameCount);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ticksToMicroSeconds(profile->GetAverageSelfTicks()));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ticksToMicroSeconds(profile->GetSelfTicks()) / frameCount);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ticksToMicroSeconds(profile->GetMinTicks()));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ticksToMicroSeconds(profile->GetAverageTicks()));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", ticksToMicroSeconds(profile->GetMaxTicks()));
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::CollapsingHeader("Histograms (log2 ticks, inclusive)")) {
+        for (const exl::hook::HookProfile *profile : profiles) {
+            if (!profile)
+                continue;
+
+            float buckets[exl::hook::HookProfile::HistogramBucketCount];
+            for (size_t i = 0; i < exl::hook::HookProfile::HistogramBucketCount; i++)
+                buckets[i] = profile->GetHistogramBucket(i);
+
+            ImGui::PlotHistogram(profile->GetName(), buckets, exl::hook::HookProfile::HistogramBucketCount, 0,
+                                 nullptr, 0.f, FLT_MAX, ImVec2(0, 40));
+        }
+    }
+
+    ImGui::End();
+}
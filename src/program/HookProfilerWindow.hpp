@@ -0,0 +1,8 @@
+#pragma once
+
+static constexpr const char *HOOK_PROFILE_PATH = "sd:/koopafreerun_hookprofile.csv";
+
+// Shows the call counts and timings of every hook defined with HOOK_DEFINE_PROFILED_TRAMPOLINE.
+void drawHookProfilerWindow();
+
+bool exportHookProfiles(const char *path = HOOK_PROFILE_PATH);
@@ -0,0 +1,370 @@
+#include "InputPlayer.hpp"
+
+#include <algorithm>
+
+#include "logger/Logger.hpp"
+
+namespace {
+    constexpr size_t READER_STACK_SIZE = 0x4000;
+    // above the game's loading threads, so the ring is refilled before the hid hooks run dry
+    constexpr s32 READER_THREAD_PRIORITY = 16;
+
+    alignas(0x1000) u8 readerThreadStack[READER_STACK_SIZE];
+
+    struct ScopedLock {
+        explicit ScopedLock(nn::os::MutexType &mutex) : mMutex(mutex) { nn::os::LockMutex(&mMutex); }
+        ~ScopedLock() { nn::os::UnlockMutex(&mMutex); }
+        nn::os::MutexType &mMutex;
+    };
+
+    s64 fromZigzag(u64 value) {
+        return static_cast<s64>(value >> 1) ^ -static_cast<s64>(value & 1);
+    }
+}
+
+InputPlayer &InputPlayer::instance() {
+    static InputPlayer instance = {};
+    return instance;
+}
+
+void InputPlayer::initReader() {
+    if (m_isReaderInitialized)
+        return;
+
+    nn::os::InitializeMutex(&m_fileMutex, false, 0);
+    nn::os::InitializeMessageQueue(&m_readerQueue, m_readerQueueBuffer, ACNT(m_readerQueueBuffer));
+    R_ABORT_UNLESS(nn::os::CreateThread(&m_readerThread, readerThreadMain, this, readerThreadStack,
+                                        READER_STACK_SIZE, READER_THREAD_PRIORITY));
+    nn::os::SetThreadName(&m_readerThread, "InputPlayerReader");
+    nn::os::StartThread(&m_readerThread);
+
+    m_isReaderInitialized = true;
+}
+
+void InputPlayer::readerThreadMain(void *arg) {
+    InputPlayer *player = (InputPlayer *) arg;
+
+    while (true) {
+        u64 message = 0;
+        nn::os::ReceiveMessageQueue(&message, &player->m_readerQueue);
+
+        ScopedLock lock(player->m_fileMutex);
+        if (!(message & CLOSE_MESSAGE))
+            player->fillChunks();
+        else if (static_cast<u32>(message) == player->m_fileGeneration)
+            player->closeFile();
+    }
+}
+
+void InputPlayer::closeFile() {
+    if (!m_isFileOpen)
+        return;
+
+    nn::fs::CloseFile(m_file);
+    m_isFileOpen = false;
+}
+
+void InputPlayer::fillChunks() {
+    // chunks are filled and consumed in ring order, so the first one still in use ends the pass
+    while (m_isFileOpen && m_nextReadOffset < m_fileEnd) {
+        Chunk &chunk = m_chunks[m_nextFillChunk];
+        if (chunk.isReady.load(std::memory_order_acquire))
+            break;
+
+        u32 size = std::min<s64>(CHUNK_SIZE, m_fileEnd - m_nextReadOffset);
+        if (nn::fs::ReadFile(m_file, m_nextReadOffset, chunk.data, size).isFailure()) {
+            Logger::log("InputPlayer: read failed at 0x%lx\n", m_nextReadOffset);
+            break;
+        }
+
+        chunk.size = size;
+        chunk.isReady.store(true, std::memory_order_release);
+        m_nextReadOffset += size;
+        m_nextFillChunk = (m_nextFillChunk + 1) % CHUNK_COUNT;
+    }
+}
+
+bool InputPlayer::start(const char *path) {
+    initReader();
+
+    {
+        exl::util::ScopedSpinLock lock(m_lock);
+        m_isPlaying = false;
+    }
+
+    ScopedLock fileLock(m_fileMutex);
+    closeFile();
+    m_fileGeneration++;
+
+    for (Chunk &chunk : m_chunks)
+        chunk.isReady.store(false, std::memory_order_relaxed);
+
+    if (nn::fs::OpenFile(&m_file, path, nn::fs::OpenMode_Read).isFailure()) {
+        Logger::log("InputPlayer: could not open %s\n", path);
+        return false;
+    }
+    m_isFileOpen = true;
+
+    long fileSize = 0;
+    InputRecorder::FileHeader header = {};
+    nn::fs::GetFileSize(&fileSize, m_file);
+    if (fileSize < (long) sizeof(header) || nn::fs::ReadFile(m_file, 0, &header, sizeof(header)).isFailure() ||
+        header.magic != InputRecorder::FILE_MAGIC || header.version != InputRecorder::FILE_VERSION ||
+        header.dataSize == 0 || fileSize < (long) (sizeof(header) + header.dataSize)) {
+        Logger::log("InputPlayer: %s is not an input log\n", path);
+        closeFile();
+        return false;
+    }
+
+    m_fileEnd = sizeof(header) + header.dataSize;
+    m_nextReadOffset = sizeof(header);
+    m_nextFillChunk = 0;
+
+    // the whole ring is read up front, playback only starts once the hooks have something to decode
+    fillChunks();
+
+    {
+        exl::util::ScopedSpinLock lock(m_lock);
+        m_header = header;
+        resetDecoder();
+        m_isFinished = false;
+        m_isPlaying = true;
+    }
+
+    Logger::log("InputPlayer: playing %u samples from %s\n", header.sampleCount, path);
+    return true;
+}
+
+void InputPlayer::stop() {
+    {
+        exl::util::ScopedSpinLock lock(m_lock);
+        m_isPlaying = false;
+    }
+
+    if (!m_isReaderInitialized)
+        return;
+
+    ScopedLock fileLock(m_fileMutex);
+    closeFile();
+}
+
+void InputPlayer::resetDecoder() {
+    m_readChunk = 0;
+    m_readPos = 0;
+    m_consumed = 0;
+    for (Stream &stream : m_streams)
+        stream = {};
+    m_poseFrame = 0;
+    m_sampleCount = 0;
+    m_starveCount = 0;
+    m_decodeError = {};
+}
+
+size_t InputPlayer::getAvailable() const {
+    const Chunk &chunk = m_chunks[m_readChunk];
+    if (!chunk.isReady.load(std::memory_order_acquire))
+        return 0;
+
+    // records are far smaller than a chunk, so they never span more than two
+    const Chunk &next = m_chunks[(m_readChunk + 1) % CHUNK_COUNT];
+    size_t available = chunk.size - m_readPos;
+    if (next.isReady.load(std::memory_order_acquire))
+        available += next.size;
+    return available;
+}
+
+bool InputPlayer::isDefinitionNext() const {
+    if (m_consumed == m_header.dataSize || getAvailable() == 0)
+        return false;
+
+    return m_chunks[m_readChunk].data[m_readPos] == InputRecorder::RECORD_STREAM_DEFINITION;
+}
+
+u8 InputPlayer::getByte() {
+    Chunk &chunk = m_chunks[m_readChunk];
+    u8 value = chunk.data[m_readPos++];
+    m_consumed++;
+
+    // hand the chunk back to the reader as soon as it's drained
+    if (m_readPos == chunk.size) {
+        chunk.isReady.store(false, std::memory_order_release);
+        m_readChunk = (m_readChunk + 1) % CHUNK_COUNT;
+        m_readPos = 0;
+        nn::os::TrySendMessageQueue(&m_readerQueue, 0);
+    }
+
+    return value;
+}
+
+u64 InputPlayer::getVarint() {
+    u64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        u8 byte = getByte();
+        value |= static_cast<u64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+    return value;
+}
+
+s64 InputPlayer::getSigned() {
+    return fromZigzag(getVarint());
+}
+
+InputPlayer::Stream *InputPlayer::findStream(InputRecorder::Style style, u32 port) {
+    for (Stream &stream : m_streams) {
+        if (stream.isDefined && stream.style == style && stream.port == port)
+            return &stream;
+    }
+    return nullptr;
+}
+
+void InputPlayer::pushSample(Stream &stream, const nn::hid::NpadBaseState &state) {
+    if (stream.historyCount == 0)
+        stream.firstSampling = state.mSamplingNumber;
+
+    stream.last = state;
+    stream.history[stream.historyHead] = state;
+    stream.historyHead = (stream.historyHead + 1) % HISTORY_SIZE;
+    stream.historyCount = std::min(stream.historyCount + 1, HISTORY_SIZE);
+    m_sampleCount++;
+}
+
+const nn::hid::NpadBaseState *InputPlayer::findSample(const Stream &stream, u64 samplingNumber) const {
+    const nn::hid::NpadBaseState *sample = nullptr;
+    for (int i = 1; i <= stream.historyCount; i++) {
+        sample = &stream.history[(stream.historyHead - i + HISTORY_SIZE) % HISTORY_SIZE];
+        if (sample->mSamplingNumber <= samplingNumber)
+            break;
+    }
+    // older than anything kept, the oldest sample is the closest
+    return sample;
+}
+
+bool InputPlayer::decodeRecord() {
+    u32 remaining = m_header.dataSize - m_consumed;
+    if (remaining == 0) {
+        m_isPlaying = false;
+        m_isFinished = true;
+        nn::os::TrySendMessageQueue(&m_readerQueue, CLOSE_MESSAGE | m_fileGeneration);
+        return false;
+    }
+
+    if (getAvailable() < std::min<size_t>(InputRecorder::MAX_RECORD_SIZE, remaining)) {
+        m_starveCount++;
+        return false;
+    }
+
+    u32 recordOffset = m_consumed;
+    u8 header = getByte();
+    if (header == InputRecorder::RECORD_STREAM_DEFINITION) {
+        u8 index = getByte();
+        u8 style = getByte();
+        u32 port = getVarint();
+        if (index >= InputRecorder::MAX_STREAMS) {
+            failDecode("InputPlayer: bad stream %u at 0x%x, stopping\n", index, recordOffset);
+            return false;
+        }
+
+        m_streams[index] = {.isDefined = true, .style = static_cast<InputRecorder::Style>(style), .port = port};
+        return true;
+    }
+
+    if (header == InputRecorder::RECORD_POSE_FRAME) {
+        m_poseFrame++;
+        return true;
+    }
+
+    if (header == InputRecorder::RECORD_SEGMENT) {
+        getVarint();
+        return true;
+    }
+
+    Stream &stream = m_streams[header & InputRecorder::SAMPLE_STREAM_MASK];
+    if ((header & InputRecorder::RECORD_CONTROL) || !stream.isDefined) {
+        failDecode("InputPlayer: bad record 0x%02x at 0x%x, stopping\n", header, recordOffset);
+        return false;
+    }
+
+    nn::hid::NpadBaseState state = stream.last;
+    state.mSamplingNumber += (header & InputRecorder::SAMPLE_SAMPLING_DELTA) ? getVarint() : 1;
+    if (header & InputRecorder::SAMPLE_BUTTONS)
+        state.mButtons._storage[0] ^= getVarint();
+    if (header & InputRecorder::SAMPLE_STICK_L) {
+        state.mAnalogStickL.X += getSigned();
+        state.mAnalogStickL.Y += getSigned();
+    }
+    if (header & InputRecorder::SAMPLE_STICK_R) {
+        state.mAnalogStickR.X += getSigned();
+        state.mAnalogStickR.Y += getSigned();
+    }
+
+    pushSample(stream, state);
+    return true;
+}
+
+void InputPlayer::failDecode(const char *format, u32 value, u32 offset) {
+    m_isPlaying = false;
+    m_decodeError = {.format = format, .value = value, .offset = offset};
+}
+
+template<typename Done>
+bool InputPlayer::decodeUntil(Done isDone) {
+    for (int i = 0; i < MAX_RECORDS_PER_POLL && !isDone(); i++) {
+        if (!decodeRecord())
+            break;
+    }
+    return isDone();
+}
+
+void InputPlayer::apply(InputRecorder::Style style, u32 port, nn::hid::NpadBaseState *states, size_t stateSize, int count) {
+    if (!m_isPlaying || count <= 0)
+        return;
+
+    DecodeError error;
+    {
+        exl::util::ScopedSpinLock lock(m_lock);
+        if (!m_isPlaying)
+            return;
+
+        applyLocked(style, port, states, stateSize, count);
+        error = m_decodeError;
+        m_decodeError = {};
+    }
+
+    // the logger blocks on the socket, so other hid hooks aren't kept spinning on the lock meanwhile
+    if (error.format)
+        Logger::log(error.format, error.value, error.offset);
+}
+
+void InputPlayer::applyLocked(InputRecorder::Style style, u32 port, nn::hid::NpadBaseState *states, size_t stateSize, int count) {
+    // Streams the log never saw keep the live inputs. Only definitions right at the read position are looked at, the
+    // rest turn up while decoding for the streams that are in the log, so polling an absent one never decodes ahead.
+    Stream *stream = findStream(style, port);
+    while (!stream && isDefinitionNext() && decodeRecord())
+        stream = findStream(style, port);
+    if (!stream)
+        return;
+
+    if (!stream->isAnchored) {
+        if (!decodeUntil([&] { return stream->historyCount > 0; }))
+            return;
+
+        stream->samplingOffset = stream->firstSampling - states[0].mSamplingNumber;
+        stream->isAnchored = true;
+    }
+
+    // the log interleaves streams, the ones decoded past along the way are kept in their histories
+    u64 target = states[0].mSamplingNumber + stream->samplingOffset;
+    decodeUntil([&] { return stream->last.mSamplingNumber >= target; });
+
+    for (int i = 0; i < count; i++) {
+        auto state = reinterpret_cast<nn::hid::NpadBaseState *>(reinterpret_cast<uintptr_t>(states) + i * stateSize);
+        const nn::hid::NpadBaseState *sample = findSample(*stream, state->mSamplingNumber + stream->samplingOffset);
+
+        // the live sampling number and attributes stay, so the game still sees a connected controller
+        state->mButtons = sample->mButtons;
+        state->mAnalogStickL = sample->mAnalogStickL;
+        state->mAnalogStickR = sample->mAnalogStickR;
+    }
+}
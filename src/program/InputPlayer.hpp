@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+
+#include <nn/result.h>
+#include <nn/fs.h>
+#include <nn/hid.h>
+#include <nn/os.h>
+
+#include "InputRecorder.hpp"
+#include "lib.hpp"
+
+// Plays an input log written by InputRecorder back through the GetNpadStates hooks.
+//
+// The log is streamed from the SD card through a ring of chunks that a background thread keeps filled, so the hid
+// hooks only ever decode from memory. When the reader falls behind, the hooks keep serving the last decoded state
+// instead of waiting for it.
+//
+// Samples are matched by sampling number: the first time a stream is polled, its newest live sample is paired with
+// the first recorded one, and every later live sample maps to the recorded sample the same distance in.
+class InputPlayer {
+public:
+    static constexpr const char *PLAYBACK_PATH = "sd:/koopafreerun/inputs.bin";
+    static constexpr size_t CHUNK_SIZE = 0x4000;
+    static constexpr int CHUNK_COUNT = 4;
+    static constexpr int HISTORY_SIZE = 16;
+    // bounds the time a single poll spends decoding, the rest is picked up by the next one
+    static constexpr int MAX_RECORDS_PER_POLL = 256;
+    // close messages carry the generation of the file they are for, so one sent before a restart can't close the new file
+    static constexpr u64 CLOSE_MESSAGE = 1ull << 63;
+
+    static InputPlayer &instance();
+
+    bool start(const char *path);
+    void stop();
+    bool isPlaying() const { return m_isPlaying; }
+
+    // True once after the log was played to its end.
+    bool takeFinished() { return m_isFinished.exchange(false); }
+
+    // Called from the hid hooks with the states GetNpadStates returned, newest first. Overwrites buttons and sticks.
+    void apply(InputRecorder::Style style, u32 port, nn::hid::NpadBaseState *states, size_t stateSize, int count);
+
+    u32 getPoseFrame() const { return m_poseFrame; }
+    u32 getSampleCount() const { return m_sampleCount; }
+    u32 getTotalSampleCount() const { return m_header.sampleCount; }
+    u32 getStarveCount() const { return m_starveCount; }
+
+private:
+    struct Chunk {
+        u8 data[CHUNK_SIZE];
+        u32 size;
+        std::atomic<bool> isReady;
+    };
+
+    struct Stream {
+        bool isDefined;
+        InputRecorder::Style style;
+        u32 port;
+        bool isAnchored;
+        u64 firstSampling;
+        s64 samplingOffset;
+        nn::hid::NpadBaseState last;
+        nn::hid::NpadBaseState history[HISTORY_SIZE];
+        int historyCount;
+        int historyHead;
+    };
+
+    // decoding errors are logged once the decoder's lock is released
+    struct DecodeError {
+        const char *format;
+        u32 value;
+        u32 offset;
+    };
+
+    static void readerThreadMain(void *arg);
+
+    void initReader();
+    void closeFile();
+    void fillChunks();
+
+    void resetDecoder();
+    size_t getAvailable() const;
+    bool isDefinitionNext() const;
+    u8 getByte();
+    u64 getVarint();
+    s64 getSigned();
+    bool decodeRecord();
+    void failDecode(const char *format, u32 value, u32 offset);
+    template<typename Done>
+    bool decodeUntil(Done isDone);
+    void pushSample(Stream &stream, const nn::hid::NpadBaseState &state);
+    const nn::hid::NpadBaseState *findSample(const Stream &stream, u64 samplingNumber) const;
+    Stream *findStream(InputRecorder::Style style, u32 port);
+    void applyLocked(InputRecorder::Style style, u32 port, nn::hid::NpadBaseState *states, size_t stateSize, int count);
+
+    // taken by the reader thread around file reads, and by start/stop to swap the file under it
+    nn::os::MutexType m_fileMutex;
+    nn::os::ThreadType m_readerThread;
+    nn::os::MessageQueueType m_readerQueue;
+    u64 m_readerQueueBuffer[CHUNK_COUNT + 1];
+    bool m_isReaderInitialized = false;
+
+    nn::fs::FileHandle m_file;
+    bool m_isFileOpen = false;
+    // bumped by start, only written with m_fileMutex held and the decoder stopped
+    u32 m_fileGeneration = 0;
+    s64 m_fileEnd = 0;
+    s64 m_nextReadOffset = 0;
+    int m_nextFillChunk = 0;
+
+    Chunk m_chunks[CHUNK_COUNT];
+
+    // guards the decoder, which is driven from the hid hooks
+    exl::util::SpinLock m_lock;
+    std::atomic<bool> m_isPlaying = false;
+    std::atomic<bool> m_isFinished = false;
+    InputRecorder::FileHeader m_header = {};
+    int m_readChunk = 0;
+    u32 m_readPos = 0;
+    u32 m_consumed = 0;
+    Stream m_streams[InputRecorder::MAX_STREAMS] = {};
+    u32 m_poseFrame = 0;
+    u32 m_sampleCount = 0;
+    u32 m_starveCount = 0;
+    DecodeError m_decodeError = {};
+};
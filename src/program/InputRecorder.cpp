@@ -0,0 +1,174 @@
+#include "InputRecorder.hpp"
+
+#include <cstring>
+
+#include "KoopaFreerunRecorder.hpp"
+#include "logger/Logger.hpp"
+
+namespace {
+    u64 toZigzag(s64 value) {
+        return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+    }
+}
+
+InputRecorder &InputRecorder::instance() {
+    static InputRecorder instance = {};
+    return instance;
+}
+
+void InputRecorder::start(u8 *buffer, size_t size) {
+    exl::util::ScopedSpinLock lock(m_lock);
+
+    m_buffer = buffer;
+    m_capacity = size;
+    // room for the file header, filled in when the log is written
+    m_size = sizeof(FileHeader);
+    m_sampleCount = 0;
+    m_streamCount = 0;
+    m_isOverflowed = false;
+    m_isRecording = buffer != nullptr && size > sizeof(FileHeader) && m_isEnabled;
+}
+
+void InputRecorder::stop() {
+    exl::util::ScopedSpinLock lock(m_lock);
+    m_isRecording = false;
+}
+
+int InputRecorder::findOrAddStream(Style style, u32 port) {
+    for (int i = 0; i < m_streamCount; i++) {
+        if (m_streams[i].style == style && m_streams[i].port == port)
+            return i;
+    }
+
+    if (m_streamCount >= MAX_STREAMS || !reserve(MAX_RECORD_SIZE))
+        return -1;
+
+    int index = m_streamCount++;
+    m_streams[index] = {.style = style, .port = port, .last = {}};
+
+    putByte(RECORD_STREAM_DEFINITION);
+    putByte(index);
+    putByte(static_cast<u8>(style));
+    putVarint(port);
+    return index;
+}
+
+void InputRecorder::capture(Style style, u32 port, const nn::hid::NpadBaseState *states, size_t stateSize, int count) {
+    if (!m_isRecording || count <= 0)
+        return;
+
+    exl::util::ScopedSpinLock lock(m_lock);
+    if (!m_isRecording)
+        return;
+
+    int streamIndex = findOrAddStream(style, port);
+    if (streamIndex < 0)
+        return;
+
+    // the history is newest first, anything the game polled earlier was already recorded
+    u64 lastSampling = m_streams[streamIndex].last.mSamplingNumber;
+    for (int i = count - 1; i >= 0; i--) {
+        auto state = reinterpret_cast<const nn::hid::NpadBaseState *>(reinterpret_cast<uintptr_t>(states) + i * stateSize);
+        if (state->mSamplingNumber > lastSampling)
+            appendSample(streamIndex, *state);
+    }
+}
+
+void InputRecorder::appendSample(int streamIndex, const nn::hid::NpadBaseState &state) {
+    if (!reserve(MAX_RECORD_SIZE))
+        return;
+
+    nn::hid::NpadBaseState &last = m_streams[streamIndex].last;
+
+    u64 buttons = state.mButtons._storage[0];
+    u64 lastButtons = last.mButtons._storage[0];
+    u64 samplingDelta = state.mSamplingNumber - last.mSamplingNumber;
+    bool isStickLChanged = state.mAnalogStickL.X != last.mAnalogStickL.X || state.mAnalogStickL.Y != last.mAnalogStickL.Y;
+    bool isStickRChanged = state.mAnalogStickR.X != last.mAnalogStickR.X || state.mAnalogStickR.Y != last.mAnalogStickR.Y;
+
+    u8 header = streamIndex & SAMPLE_STREAM_MASK;
+    if (buttons != lastButtons)
+        header |= SAMPLE_BUTTONS;
+    if (isStickLChanged)
+        header |= SAMPLE_STICK_L;
+    if (isStickRChanged)
+        header |= SAMPLE_STICK_R;
+    if (samplingDelta != 1)
+        header |= SAMPLE_SAMPLING_DELTA;
+
+    putByte(header);
+    if (header & SAMPLE_SAMPLING_DELTA)
+        putVarint(samplingDelta);
+    if (header & SAMPLE_BUTTONS)
+        putVarint(buttons ^ lastButtons);
+    if (header & SAMPLE_STICK_L) {
+        putSigned(state.mAnalogStickL.X - last.mAnalogStickL.X);
+        putSigned(state.mAnalogStickL.Y - last.mAnalogStickL.Y);
+    }
+    if (header & SAMPLE_STICK_R) {
+        putSigned(state.mAnalogStickR.X - last.mAnalogStickR.X);
+        putSigned(state.mAnalogStickR.Y - last.mAnalogStickR.Y);
+    }
+
+    last = state;
+    m_sampleCount++;
+}
+
+void InputRecorder::markPoseFrame() {
+    exl::util::ScopedSpinLock lock(m_lock);
+    if (m_isRecording && reserve(1))
+        putByte(RECORD_POSE_FRAME);
+}
+
+void InputRecorder::markSegment(int index) {
+    exl::util::ScopedSpinLock lock(m_lock);
+    if (m_isRecording && reserve(MAX_RECORD_SIZE)) {
+        putByte(RECORD_SEGMENT);
+        putVarint(index);
+    }
+}
+
+bool InputRecorder::reserve(size_t size) {
+    if (m_size + size <= m_capacity)
+        return true;
+
+    if (!m_isOverflowed)
+        Logger::log("Input log is full, inputs after sample %u are not recorded\n", m_sampleCount);
+
+    // nothing is appended past the first record that didn't fit, so the log stays decodable
+    m_isOverflowed = true;
+    m_isRecording = false;
+    return false;
+}
+
+void InputRecorder::putByte(u8 value) {
+    m_buffer[m_size++] = value;
+}
+
+void InputRecorder::putVarint(u64 value) {
+    while (value >= 0x80) {
+        putByte(static_cast<u8>(value) | 0x80);
+        value >>= 7;
+    }
+    putByte(static_cast<u8>(value));
+}
+
+void InputRecorder::putSigned(s64 value) {
+    putVarint(toZigzag(value));
+}
+
+bool InputRecorder::writeToFile(const char *path) const {
+    if (!m_buffer || m_size < sizeof(FileHeader))
+        return false;
+
+    // the header goes in front of the data, in space kept free for it by the caller
+    FileHeader header = {
+        .magic = FILE_MAGIC,
+        .version = FILE_VERSION,
+        .dataSize = static_cast<u32>(m_size - sizeof(FileHeader)),
+        .sampleCount = m_sampleCount,
+    };
+    memcpy(m_buffer, &header, sizeof(header));
+
+    return writeFileToPath(m_buffer, m_size, path).isSuccess();
+}
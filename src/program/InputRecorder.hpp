@@ -0,0 +1,98 @@
+#pragma once
+
+#include <nn/hid.h>
+
+#include "lib.hpp"
+
+// Captures controller input from the GetNpadStates hooks into a compact log, next to the pose recording.
+//
+// Each (style, port) pair the game polls becomes a stream, and every new sample of a stream is stored as the
+// difference from the one before it. Most samples only change a few stick units, so they take a few bytes.
+//
+// Record layout, one header byte followed by its payload:
+//   0b0DRLBsss   sample of stream s. B: button xor (varint), L/R: stick x/y deltas (zigzag varints),
+//                D: sampling number delta (varint), a delta of 1 otherwise.
+//   0x80         stream definition: stream index (u8), style (u8), port (varint).
+//   0x81         the pose recorder recorded a frame.
+//   0x82         the pose recorder started a new segment: segment index (varint).
+class InputRecorder {
+public:
+    enum class Style : u8 {
+        FullKey,
+        Handheld,
+        JoyDual,
+        JoyLeft,
+        JoyRight,
+    };
+
+    struct FileHeader {
+        u32 magic;
+        u32 version;
+        u32 dataSize;
+        u32 sampleCount;
+    };
+
+    static constexpr u32 FILE_MAGIC = 0x4E49464B; // KFIN
+    static constexpr u32 FILE_VERSION = 1;
+    static constexpr int MAX_STREAMS = 8;
+    // the largest record: header, sampling delta, buttons and both sticks as 10 byte varints
+    static constexpr size_t MAX_RECORD_SIZE = 1 + 10 + 10 + 4 * 10;
+    static constexpr u8 RECORD_CONTROL = 0x80;
+    static constexpr u8 RECORD_STREAM_DEFINITION = 0x80;
+    static constexpr u8 RECORD_POSE_FRAME = 0x81;
+    static constexpr u8 RECORD_SEGMENT = 0x82;
+    static constexpr u8 SAMPLE_STREAM_MASK = 0x07;
+    static constexpr u8 SAMPLE_BUTTONS = 1 << 3;
+    static constexpr u8 SAMPLE_STICK_L = 1 << 4;
+    static constexpr u8 SAMPLE_STICK_R = 1 << 5;
+    static constexpr u8 SAMPLE_SAMPLING_DELTA = 1 << 6;
+
+    static InputRecorder &instance();
+
+    // The buffer is owned by the caller and has to outlive the recording.
+    void start(u8 *buffer, size_t size);
+    void stop();
+    bool isRecording() const { return m_isRecording; }
+
+    // Called from the hid hooks with the states GetNpadStates returned, newest first.
+    void capture(Style style, u32 port, const nn::hid::NpadBaseState *states, size_t stateSize, int count);
+
+    void markPoseFrame();
+    void markSegment(int index);
+
+    bool writeToFile(const char *path) const;
+
+    size_t getSize() const { return m_size; }
+    size_t getCapacity() const { return m_capacity; }
+    u32 getSampleCount() const { return m_sampleCount; }
+    bool isOverflowed() const { return m_isOverflowed; }
+
+    bool isEnabled() const { return m_isEnabled; }
+    void setEnabled(bool isEnabled) { m_isEnabled = isEnabled; }
+
+private:
+    struct Stream {
+        Style style;
+        u32 port;
+        nn::hid::NpadBaseState last;
+    };
+
+    int findOrAddStream(Style style, u32 port);
+    void appendSample(int streamIndex, const nn::hid::NpadBaseState &state);
+
+    bool reserve(size_t size);
+    void putByte(u8 value);
+    void putVarint(u64 value);
+    void putSigned(s64 value);
+
+    exl::util::SpinLock m_lock;
+    bool m_isEnabled = true;
+    bool m_isRecording = false;
+    bool m_isOverflowed = false;
+    u8 *m_buffer = nullptr;
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+    u32 m_sampleCount = 0;
+    Stream m_streams[MAX_STREAMS] = {};
+    int m_streamCount = 0;
+};
@@ -1,20 +1,26 @@
 #include "KoopaFreerunRecorder.hpp"
 
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
 #include <optional>
 #include <string>
 
 #include <nn/fs.h>
-#include <al/Library/Memory/HeapUtil.h>
+#include <basis/seadNew.hpp>
 #include <sead/stream/seadStream.h>
 #include <sead/stream/seadStreamSrc.h>
 
 #include <sead/math/seadQuatCalcCommon.h>
 #include <al/Library/LiveActor/ActorPoseKeeper.h>
+#include <game/GameData/GameDataFunction.h>
+#include <game/StageScene/StageScene.h>
 
+#include "FrameMonitor.hpp"
+#include "InputPlayer.hpp"
+#include "InputRecorder.hpp"
 #include "logger/Logger.hpp"
 
-const char* RECORDING_PATH = "sd:/koopafreerun.byml";
-
 bool isFileExist(const char *path) {
     nn::fs::DirectoryEntryType type;
     nn::fs::GetEntryType(&type, path);
@@ -23,6 +29,7 @@ bool isFileExist(const char *path) {
 }
 
 nn::Result writeFileToPath(void *buf, size_t size, const char *path) {
+    FrameMonitor::Scope scope(FrameMonitor::Activity::FileIo);
     nn::fs::FileHandle handle;
 
     if (isFileExist(path)) {
@@ -47,37 +54,141 @@ nn::Result writeFileToPath(void *buf, size_t size, const char *path) {
     return 0;
 }
 
+bool appendFormat(char *buffer, size_t bufferSize, size_t &length, const char *format, ...) {
+    if (length >= bufferSize)
+        return false;
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + length, bufferSize - length, format, args);
+    va_end(args);
+
+    // a cut off line is dropped, the caller only ever writes out the first length bytes
+    if (written < 0 || (size_t) written >= bufferSize - length)
+        return false;
+
+    length += written;
+    return true;
+}
+
+void KoopaFreerunRecorder::init(sead::Heap *parent) {
+    if (m_heap)
+        return;
+
+    m_heap = sead::FrameHeap::tryCreate(ARENA_SIZE, "KoopaFreerunRecorderHeap", parent, 8,
+                                        sead::Heap::cHeapDirection_Forward, false);
+    if (!m_heap)
+        Logger::log("KoopaFreerunRecorder: unable to create a 0x%lx byte arena, recording disabled\n", ARENA_SIZE);
+}
+
+void KoopaFreerunRecorder::resetArena() {
+    // the writers' destructors would only walk every node to free it into a heap that ignores frees
+    for (Segment *&segment : m_segments)
+        segment = nullptr;
+    m_segmentCount = 0;
+    m_heap->freeAll();
+}
+
+size_t KoopaFreerunRecorder::getArenaSize() const {
+    return m_heap ? m_heap->getSize() : 0;
+}
+
+size_t KoopaFreerunRecorder::getArenaUsedSize() const {
+    return m_heap ? m_heap->getSize() - m_heap->getFreeSize() : 0;
+}
+
 void KoopaFreerunRecorder::startRecording() {
+    if (!m_heap) {
+        Logger::log("KoopaFreerunRecorder: no arena, can't record\n");
+        return;
+    }
+
+    resetArena();
+
+    // the input log is sized up front, the hid hooks can't allocate from the arena
+    // starting without a buffer still clears the log of the last recording, which lived in the arena
+    InputRecorder &inputs = InputRecorder::instance();
+    u8 *inputLog = inputs.isEnabled() ? static_cast<u8 *>(m_heap->tryAlloc(INPUT_LOG_SIZE, 8)) : nullptr;
+    if (inputs.isEnabled() && !inputLog)
+        Logger::log("Out of memory, inputs are not recorded\n");
+    inputs.start(inputLog, inputLog ? INPUT_LOG_SIZE : 0);
+
+    // the first segment is opened by the first recorded frame, once the stage is known
+    m_isStageChangePending = true;
     m_isRecording = true;
-    m_byamlWriter = std::make_unique<al::ByamlWriter>(al::getWorldResourceHeap(), true);
-    m_byamlWriter->pushHash();
-    m_byamlWriter->addString("HackName", "");
-    m_byamlWriter->pushArray("MaterialCode");
-        m_byamlWriter->addString("Sand");
-        m_byamlWriter->addString("NoCollide");
-        m_byamlWriter->addString("Puddle");
-        m_byamlWriter->addString("Lawn");
-        m_byamlWriter->addString("Soil");
-        m_byamlWriter->pop();
-    m_byamlWriter->pushArray("ActionName");
-        m_byamlWriter->addString("Wait");
-        m_byamlWriter->addString("Move");
-        m_byamlWriter->addString("Jump");
-        m_byamlWriter->addString("Jump2");
-        m_byamlWriter->addString("Jump3");
-        m_byamlWriter->addString("SpinCapStart");
-        m_byamlWriter->addString("NoDamageDown");
-        m_byamlWriter->addString("DamageLand");
-        m_byamlWriter->addString("SquatStart");
-        m_byamlWriter->addString("JumpBroad");
-        m_byamlWriter->addString("JumpReverse");
-        m_byamlWriter->pop();
-    m_byamlWriter->pushArray("ActionNameCap");
-        m_byamlWriter->addString("SpinCapStart");
-        m_byamlWriter->addString("FlyingWaitR");
-        m_byamlWriter->addString("StayR");
-        m_byamlWriter->pop();
-    m_byamlWriter->pushArray("DataArray");
+}
+
+void KoopaFreerunRecorder::onStageSceneInit() {
+    m_isStageChangePending = true;
+}
+
+bool KoopaFreerunRecorder::beginSegment(StageScene *scene, PlayerActorBase *playerBase) {
+    if (m_segmentCount > 0)
+        endSegment(*m_segments[m_segmentCount - 1]);
+
+    if (m_segmentCount >= MAX_SEGMENTS) {
+        Logger::log("Too many stages in one recording, stopping\n");
+        return false;
+    }
+
+    Segment *segment = new (m_heap, std::nothrow) Segment();
+    al::ByamlWriter *writer = segment ? new (m_heap, std::nothrow) al::ByamlWriter(m_heap, true) : nullptr;
+    if (!writer) {
+        Logger::log("Out of memory, could not create the recording writer\n");
+        return false;
+    }
+
+    segment->writer = writer;
+    segment->stageName = scene->mStageName;
+    segment->scenarioNo = GameDataFunction::getScenarioNo(playerBase);
+    segment->frameCount = 0;
+    m_segments[m_segmentCount++] = segment;
+    InputRecorder::instance().markSegment(m_segmentCount - 1);
+
+    Logger::log("Recording segment %d: %s, scenario %d\n", m_segmentCount, segment->stageName.cstr(),
+                segment->scenarioNo);
+
+    writer->pushHash();
+    writer->addString("HackName", "");
+    writer->addString("StageName", segment->stageName.cstr());
+    writer->addInt("ScenarioNo", segment->scenarioNo);
+    writer->pushArray("MaterialCode");
+        writer->addString("Sand");
+        writer->addString("NoCollide");
+        writer->addString("Puddle");
+        writer->addString("Lawn");
+        writer->addString("Soil");
+        writer->pop();
+    writer->pushArray("ActionName");
+        writer->addString("Wait");
+        writer->addString("Move");
+        writer->addString("Jump");
+        writer->addString("Jump2");
+        writer->addString("Jump3");
+        writer->addString("SpinCapStart");
+        writer->addString("NoDamageDown");
+        writer->addString("DamageLand");
+        writer->addString("SquatStart");
+        writer->addString("JumpBroad");
+        writer->addString("JumpReverse");
+        writer->pop();
+    writer->pushArray("ActionNameCap");
+        writer->addString("SpinCapStart");
+        writer->addString("FlyingWaitR");
+        writer->addString("StayR");
+        writer->pop();
+    writer->pushArray("DataArray");
+
+    return true;
+}
+
+void KoopaFreerunRecorder::endSegment(Segment &segment) {
+    if (!segment.writer)
+        return;
+
+    // closes DataArray and the root hash
+    segment.writer->pop();
+    segment.writer->pop();
 }
 
 namespace sead {
@@ -126,39 +237,102 @@ private:
 // static_assert(sizeof(sead::RamWriteStream) == 0x38, "sead::RamWriteStream unexpected size");
 // static_assert(sizeof(sead::RamStreamSrc) == 0x18, "sead::RamStreamSrc unexpected size");
 
-void KoopaFreerunRecorder::stopRecording() {
-    m_isRecording = false;
-    m_byamlWriter->pop();
-    m_byamlWriter->pop();
-
-    auto const length = m_byamlWriter->calcHeaderSize() + m_byamlWriter->calcPackSize();
+void KoopaFreerunRecorder::writeSegments() {
+    // every segment is packed into the same buffer in turn
+    u32 maxLength = 0;
+    for (int i = 0; i < m_segmentCount; i++) {
+        al::ByamlWriter *writer = m_segments[i]->writer;
+        maxLength = std::max<u32>(maxLength, writer->calcHeaderSize() + writer->calcPackSize());
+    }
 
-    auto heap = al::getWorldResourceHeap();
-    char* buffer = (char*)heap->tryAlloc(length, 8);
+    char* buffer = (char*)m_heap->tryAlloc(maxLength, 8);
     if (!buffer) {
         Logger::log("Out of memory, could not allocate buffer\n");
         return;
     }
-    sead::MyRamWriteStream ws(buffer, length, sead::Stream::Modes::Binary);
-    m_byamlWriter->write(&ws);
-    // const u32 BUF_SIZE = 1;
-    // for (int i = 0; i < length; i+=BUF_SIZE) {
-    //     writeFile(RECORDING_PATH, i, buffer+i, std::min(BUF_SIZE, length-i));
-    // }
-    writeFileToPath(buffer, length, RECORDING_PATH);
-    // char magicNum[2] = {'Y', 'B'};
-    // writeFile(RECORDING_PATH, 0, magicNum, sizeof(magicNum));
+
+    nn::fs::CreateDirectory(RECORDING_DIR);
+
+    for (int i = 0; i < m_segmentCount; i++) {
+        Segment &segment = *m_segments[i];
+
+        // a stage visited more than once gets a suffix from the second visit on
+        int visit = 0;
+        for (int j = 0; j < i; j++) {
+            if (m_segments[j]->stageName == segment.stageName && m_segments[j]->scenarioNo == segment.scenarioNo)
+                visit++;
+        }
+
+        char path[0x100];
+        if (visit == 0)
+            snprintf(path, sizeof(path), "%s/%s_%d.byml", RECORDING_DIR, segment.stageName.cstr(), segment.scenarioNo);
+        else
+            snprintf(path, sizeof(path), "%s/%s_%d_%d.byml", RECORDING_DIR, segment.stageName.cstr(),
+                     segment.scenarioNo, visit);
+
+        auto const length = segment.writer->calcHeaderSize() + segment.writer->calcPackSize();
+        sead::MyRamWriteStream ws(buffer, length, sead::Stream::Modes::Binary);
+        segment.writer->write(&ws);
+
+        if (writeFileToPath(buffer, length, path).isSuccess())
+            Logger::log("Wrote %u frames to %s\n", segment.frameCount, path);
+        else
+            Logger::log("Could not write %s\n", path);
+    }
+}
+
+void KoopaFreerunRecorder::writeInputLog() {
+    InputRecorder &inputs = InputRecorder::instance();
+    if (inputs.getSampleCount() == 0)
+        return;
+
+    char path[0x100];
+    snprintf(path, sizeof(path), "%s/inputs.bin", RECORDING_DIR);
+
+    if (inputs.writeToFile(path))
+        Logger::log("Wrote %u input samples (0x%lx bytes) to %s\n", inputs.getSampleCount(), inputs.getSize(), path);
+    else
+        Logger::log("Could not write %s\n", path);
+}
+
+void KoopaFreerunRecorder::stopRecording() {
+    m_isRecording = false;
+    InputRecorder::instance().stop();
+    // a recording driven by playback writes its new log over the one being played, which has to be closed first
+    InputPlayer::instance().stop();
+
+    if (m_segmentCount > 0) {
+        endSegment(*m_segments[m_segmentCount - 1]);
+        writeSegments();
+    }
+    writeInputLog();
+
+    resetArena();
 }
 
 bool KoopaFreerunRecorder::isRecording() const {
     return m_isRecording;
 }
 
-void KoopaFreerunRecorder::recordFrame(PlayerActorBase* playerBase) {
-    if (!isRecording() || !m_byamlWriter) {
+void KoopaFreerunRecorder::recordFrame(StageScene *scene, PlayerActorBase *playerBase) {
+    if (!isRecording()) {
+        return;
+    }
+
+    // the packed output has to fit in what's left, and it's a fraction of the size of the writers' nodes
+    if (m_heap->getFreeSize() < ARENA_SIZE / 4) {
+        Logger::log("Recording arena is almost full, stopping\n");
+        stopRecording();
         return;
     }
 
+    if (m_isStageChangePending.exchange(false) && !beginSegment(scene, playerBase)) {
+        stopRecording();
+        return;
+    }
+
+    Segment &segment = *m_segments[m_segmentCount - 1];
+
     sead::Vector3f rot;
     sead::QuatCalcCommon<float>::calcRPY(rot, al::getQuat(playerBase));
     rot *= 180.f/std::numbers::pi; // radians to degrees
@@ -168,24 +342,26 @@ void KoopaFreerunRecorder::recordFrame(PlayerActorBase* playerBase) {
         .animId = 1,
         .animFrame = 0,
     };
-    recordFrame(frame);
+    recordFrame(segment.writer, frame);
+    segment.frameCount++;
+    InputRecorder::instance().markPoseFrame();
 }
 
-void KoopaFreerunRecorder::recordFrame(KoopaFreerunRecorder::Frame const& frame) {
-    m_byamlWriter->pushArray();
-        m_byamlWriter->addFloat(frame.pos.x);
-        m_byamlWriter->addFloat(frame.pos.y);
-        m_byamlWriter->addFloat(frame.pos.z);
+void KoopaFreerunRecorder::recordFrame(al::ByamlWriter *writer, KoopaFreerunRecorder::Frame const& frame) {
+    writer->pushArray();
+        writer->addFloat(frame.pos.x);
+        writer->addFloat(frame.pos.y);
+        writer->addFloat(frame.pos.z);
 
-        m_byamlWriter->addFloat(frame.rot.x);
-        m_byamlWriter->addFloat(frame.rot.y);
-        m_byamlWriter->addFloat(frame.rot.z);
+        writer->addFloat(frame.rot.x);
+        writer->addFloat(frame.rot.y);
+        writer->addFloat(frame.rot.z);
 
-        m_byamlWriter->addInt(frame.animId);
-        m_byamlWriter->addFloat(frame.animFrame);
+        writer->addInt(frame.animId);
+        writer->addFloat(frame.animFrame);
 
-        m_byamlWriter->addInt(0);
-        m_byamlWriter->addInt(0);
+        writer->addInt(0);
+        writer->addInt(0);
         
-        m_byamlWriter->pop();
+        writer->pop();
 }
\ No newline at end of file
@@ -1,27 +1,73 @@
 #pragma once
 
+#include <atomic>
 #include <string>
-#include <memory>
+
+#include <nn/result.h>
+
+#include <heap/seadFrameHeap.h>
 
 #include <al/Library/Yaml/Writer/ByamlWriter.h>
 
 #include <sead/math/seadVector.h>
 #include <game/Player/PlayerActorBase.h>
+class StageScene;
+
+nn::Result writeFileToPath(void *buf, size_t size, const char *path);
 
+// Appends printf style text at buffer + length. Returns false and leaves length alone if it doesn't fit whole.
+bool appendFormat(char *buffer, size_t bufferSize, size_t &length, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+// Everything a recording allocates lives in an arena carved once from a long-lived heap, so a recording
+// survives the world and scene heaps being torn down, and is dropped in one go once written out.
+// A recording is split into one segment per stage visited, each written to its own file.
 class KoopaFreerunRecorder {
 public:
+    static constexpr size_t ARENA_SIZE = 0x800000;
+    static constexpr int MAX_SEGMENTS = 32;
+    static constexpr const char *RECORDING_DIR = "sd:/koopafreerun";
+    static constexpr size_t INPUT_LOG_SIZE = 0x40000;
+
+    void init(sead::Heap *parent);
+
     void startRecording();
     void stopRecording();
     bool isRecording() const;
-    void recordFrame(PlayerActorBase* playerBase);
+    void recordFrame(StageScene *scene, PlayerActorBase *playerBase);
+
+    // Called from StageScene::init, which may run on a loading thread. The next recorded frame opens a new segment.
+    void onStageSceneInit();
+
+    size_t getArenaSize() const;
+    size_t getArenaUsedSize() const;
+    int getSegmentCount() const { return m_segmentCount; }
 private:
+    struct Segment {
+        al::ByamlWriter *writer;
+        sead::FixedSafeString<0x40> stageName;
+        s32 scenarioNo;
+        u32 frameCount;
+    };
+
+    // Drops the writers along with everything else in the arena.
+    void resetArena();
+
+    bool beginSegment(StageScene *scene, PlayerActorBase *playerBase);
+    void endSegment(Segment &segment);
+    void writeSegments();
+    void writeInputLog();
+
     bool m_isRecording = false;
-    std::unique_ptr<al::ByamlWriter> m_byamlWriter = nullptr;
+    std::atomic<bool> m_isStageChangePending = false;
+    sead::FrameHeap *m_heap = nullptr;
+    Segment *m_segments[MAX_SEGMENTS] = {};
+    int m_segmentCount = 0;
 
     struct Frame {
         sead::Vector3f pos, rot;
         int animId;
         float animFrame;
     };
-    void recordFrame(Frame const& frame);
+    void recordFrame(al::ByamlWriter *writer, Frame const& frame);
 };
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "ModuleHeapWindow.hpp"
+
+#include <cstdio>
+
+#include "imgui.h"
+#include "lib.hpp"
+
+namespace {
+    void drawClassRow(const char *label, const exl::heap::ClassStats &stats) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", label);
+        ImGui::TableNextColumn();
+        ImGui::Text("%zu", stats.m_InUse);
+        ImGui::TableNextColumn();
+        ImGui::Text("%zu", stats.m_PeakInUse);
+        ImGui::TableNextColumn();
+        ImGui::Text("%zu", stats.m_Pages);
+        ImGui::TableNextColumn();
+        ImGui::Text("%lu", stats.m_Allocations);
+        ImGui::TableNextColumn();
+        if (stats.m_Failures != 0)
+            ImGui::TextColored(ImVec4(1.f, 0.3f, 0.3f, 1.f), "%lu", stats.m_Failures);
+        else
+            ImGui::Text("0");
+    }
+}
+
+void drawModuleHeapWindow() {
+    ImGui::Begin("Module Heap");
+
+    if (!exl::heap::IsInitialized()) {
+        ImGui::Text("Not in use, EXL_USE_FAKEHEAP is off");
+        ImGui::End();
+        return;
+    }
+
+    exl::heap::Stats stats;
+    exl::heap::GetStats(&stats);
+
+    float usage = stats.m_TotalPages == 0 ? 0.f : (float) stats.m_UsedPages / stats.m_TotalPages;
+    char overlay[0x40];
+    snprintf(overlay, sizeof(overlay), "%zu / %zu pages (peak %zu)", stats.m_UsedPages, stats.m_TotalPages,
+             stats.m_PeakUsedPages);
+    ImGui::ProgressBar(usage, ImVec2(-1, 0), overlay);
+
+    if (ImGui::Button("Reset peaks"))
+        exl::heap::ResetPeaks();
+
+    if (ImGui::BeginTable("Classes", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Size");
+        ImGui::TableSetupColumn("In use");
+        ImGui::TableSetupColumn("Peak");
+        ImGui::TableSetupColumn("Pages");
+        ImGui::TableSetupColumn("Allocs");
+        ImGui::TableSetupColumn("Failed");
+        ImGui::TableHeadersRow();
+
+        for (const exl::heap::ClassStats &classStats : stats.m_Classes) {
+            // classes that were never used only add noise
+            if (classStats.m_Allocations == 0 && classStats.m_Failures == 0)
+                continue;
+
+            char label[0x10];
+            snprintf(label, sizeof(label), "0x%zx", classStats.m_ChunkSize);
+            drawClassRow(label, classStats);
+        }
+        drawClassRow("Pages", stats.m_Large);
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
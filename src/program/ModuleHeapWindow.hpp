@@ -0,0 +1,4 @@
+#pragma once
+
+// Shows how the module's own heap, the one behind malloc and new, is used per size class.
+void drawModuleHeapWindow();
@@ -0,0 +1,65 @@
+#include "SymbolCacheStorage.hpp"
+
+#include <nn/result.h>
+#include <nn/fs.h>
+
+#include "init.h"
+#include "lib.hpp"
+#include "KoopaFreerunRecorder.hpp"
+#include "logger/Logger.hpp"
+
+namespace {
+    bool isMounted = false;
+
+    bool mount() {
+        if (!isMounted)
+            isMounted = nn::fs::MountSdCardForDebug(SYMBOL_CACHE_MOUNT).isSuccess();
+        return isMounted;
+    }
+
+    void unmount() {
+        if (isMounted)
+            nn::fs::Unmount(SYMBOL_CACHE_MOUNT);
+        isMounted = false;
+    }
+}
+
+void loadSymbolCache() {
+    if (!mount())
+        return;
+
+    nn::fs::FileHandle handle;
+    if (nn::fs::OpenFile(&handle, SYMBOL_CACHE_PATH, nn::fs::OpenMode_Read).isFailure())
+        return;
+
+    long size = 0;
+    nn::fs::GetFileSize(&size, handle);
+
+    // header plus every possible entry, anything bigger isn't ours
+    u8 buffer[sizeof(exl::util::symbol_cache::Header) +
+              exl::util::symbol_cache::MaxEntries * sizeof(exl::util::symbol_cache::Entry)];
+    if (size <= (long) sizeof(buffer) && nn::fs::ReadFile(handle, 0, buffer, size).isSuccess()) {
+        if (!exl::util::symbol_cache::Load(std::span(buffer, size)))
+            Logger::log("Symbol cache is stale or invalid, resolving symbols again\n");
+    }
+
+    nn::fs::CloseFile(handle);
+}
+
+void saveSymbolCache() {
+    auto stats = exl::util::symbol_cache::GetStats();
+    Logger::log("Symbol cache: %u hits, %u misses\n", stats.m_HitCount, stats.m_MissCount);
+
+    if (exl::util::symbol_cache::IsDirty() && mount()) {
+        size_t size = exl::util::symbol_cache::GetSerializedSize();
+        u8 *buffer = (u8 *) nn::init::GetAllocator()->Allocate(size);
+        if (buffer) {
+            size = exl::util::symbol_cache::Serialize(std::span(buffer, size));
+            if (size != 0)
+                writeFileToPath(buffer, size, SYMBOL_CACHE_PATH);
+            nn::init::GetAllocator()->Free(buffer);
+        }
+    }
+
+    unmount();
+}
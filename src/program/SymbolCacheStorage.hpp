@@ -0,0 +1,11 @@
+#pragma once
+
+// The game mounts "sd" itself later on, so the cache uses its own mount while hooks are installed.
+static constexpr const char *SYMBOL_CACHE_MOUNT = "exlsymcache";
+static constexpr const char *SYMBOL_CACHE_PATH = "exlsymcache:/koopafreerun_symcache.bin";
+
+// Reads the resolved symbol cache from the SD card, if one was saved for this game build.
+void loadSymbolCache();
+
+// Writes the cache back if installing hooks resolved any new symbols.
+void saveSymbolCache();
@@ -4,6 +4,8 @@
 #include "lib.hpp"
 #include "logger/Logger.hpp"
 #include "helpers/InputHelper.h"
+#include "InputPlayer.hpp"
+#include "InputRecorder.hpp"
 #include "nvn_CppFuncPtrImpl.h"
 
 nvn::Device *nvnDevice;
@@ -21,6 +23,8 @@ nvn::WindowSetCropFunc tempSetCropFunc;
 
 bool hasInitImGui = false;
 
+exl::hook::HookProfile presentTextureProfile("PresentTexture");
+
 namespace nvnImGui {
     ImVector<ProcDrawFunc> drawQueue;
 }
@@ -49,6 +53,7 @@ void setCrop(nvn::Window *window, int x, int y, int w, int h) {
 }
 
 void presentTexture(nvn::Queue *queue, nvn::Window *window, int texIndex) {
+    exl::hook::ProfileScope profile(presentTextureProfile);
 
     if (hasInitImGui)
         nvnImGui::procDraw();
@@ -95,12 +100,14 @@ nvn::GenericFuncPtrFunc getProc(nvn::Device *device, const char *procName) {
         return (nvn::GenericFuncPtrFunc) &setCrop;
     } else if (strcmp(procName, "nvnQueuePresentTexture") == 0) {
         tempPresentTexFunc = (nvn::QueuePresentTextureFunc) ptr;
+        exl::hook::RegisterProfile(presentTextureProfile);
         return (nvn::GenericFuncPtrFunc) &presentTexture;
     }
 
     return ptr;
 }
 
+// runs before the recorder captures, so the input log holds exactly what the game is handed
 void disableButtons(nn::hid::NpadBaseState *state) {
     if (!InputHelper::isReadInputs() && InputHelper::isInputToggled()) {
         // clear out the data within the state (except for the sampling number and attributes)
@@ -110,42 +117,52 @@ void disableButtons(nn::hid::NpadBaseState *state) {
     }
 }
 
-HOOK_DEFINE_TRAMPOLINE(DisableFullKeyState) {
+HOOK_DEFINE_PROFILED_TRAMPOLINE(DisableFullKeyState) {
     static int Callback(int *unkInt, nn::hid::NpadFullKeyState *state, int count, uint const &port) {
         int result = Orig(unkInt, state, count, port);
+        InputPlayer::instance().apply(InputRecorder::Style::FullKey, port, state, sizeof(*state), result);
         disableButtons(state);
+        InputRecorder::instance().capture(InputRecorder::Style::FullKey, port, state, sizeof(*state), result);
         return result;
     }
 };
 
-HOOK_DEFINE_TRAMPOLINE(DisableHandheldState) {
+HOOK_DEFINE_PROFILED_TRAMPOLINE(DisableHandheldState) {
     static int Callback(int *unkInt, nn::hid::NpadHandheldState *state, int count, uint const &port) {
         int result = Orig(unkInt, state, count, port);
+        InputPlayer::instance().apply(InputRecorder::Style::Handheld, port, state, sizeof(*state), result);
         disableButtons(state);
+        InputRecorder::instance().capture(InputRecorder::Style::Handheld, port, state, sizeof(*state), result);
         return result;
     }
 };
 
-HOOK_DEFINE_TRAMPOLINE(DisableJoyDualState) {
+HOOK_DEFINE_PROFILED_TRAMPOLINE(DisableJoyDualState) {
     static int Callback(int *unkInt, nn::hid::NpadJoyDualState *state, int count, uint const &port) {
         int result = Orig(unkInt, state, count, port);
+        InputPlayer::instance().apply(InputRecorder::Style::JoyDual, port, state, sizeof(*state), result);
         disableButtons(state);
+        InputRecorder::instance().capture(InputRecorder::Style::JoyDual, port, state, sizeof(*state), result);
         return result;
     }
 };
 
-HOOK_DEFINE_TRAMPOLINE(DisableJoyLeftState) {
+HOOK_DEFINE_PROFILED_TRAMPOLINE(DisableJoyLeftState) {
     static int Callback(int *unkInt, nn::hid::NpadJoyLeftState *state, int count, uint const &port) {
         int result = Orig(unkInt, state, count, port);
+        InputPlayer::instance().apply(InputRecorder::Style::JoyLeft, port, state, sizeof(*state), result);
         disableButtons(state);
+        InputRecorder::instance().capture(InputRecorder::Style::JoyLeft, port, state, sizeof(*state), result);
         return result;
     }
 };
 
-HOOK_DEFINE_TRAMPOLINE(DisableJoyRightState) {
+HOOK_DEFINE_PROFILED_TRAMPOLINE(DisableJoyRightState) {
     static int Callback(int *unkInt, nn::hid::NpadJoyRightState *state, int count, uint const &port) {
         int result = Orig(unkInt, state, count, port);
+        InputPlayer::instance().apply(InputRecorder::Style::JoyRight, port, state, sizeof(*state), result);
         disableButtons(state);
+        InputRecorder::instance().capture(InputRecorder::Style::JoyRight, port, state, sizeof(*state), result);
         return result;
     }
 };
@@ -24,6 +24,7 @@
 
 #include <al/Library/File/FileLoader.h>
 #include <al/Library/File/FileUtil.h>
+#include <al/Library/Memory/HeapUtil.h>
 
 #include <game/StageScene/StageScene.h>
 #include <game/System/GameSystem.h>
@@ -36,6 +37,15 @@
 #include "agl/utl.h"
 
 #include "KoopaFreerunRecorder.hpp"
+#include "ArchiveCache.hpp"
+#include "FileAccessProfiler.hpp"
+#include "FrameMonitor.hpp"
+#include "HeapMonitor.hpp"
+#include "HookProfilerWindow.hpp"
+#include "InputPlayer.hpp"
+#include "InputRecorder.hpp"
+#include "ModuleHeapWindow.hpp"
+#include "SymbolCacheStorage.hpp"
 
 static const char *DBG_FONT_PATH = "DebugData/Font/nvn_font_jis1.ntx";
 static const char *DBG_SHADER_PATH = "DebugData/Font/nvn_font_shader_jis1.bin";
@@ -46,6 +56,50 @@ static const char *DBG_TBL_PATH = "DebugData/Font/nvn_font_jis1_tbl.bin";
 sead::TextWriter *gTextWriter;
 KoopaFreerunRecorder recorder;
 
+HOOK_DEFINE_PROFILED_TRAMPOLINE(ControlHook) {
+    static void Callback(StageScene *scene) {
+        FrameMonitor &frameMonitor = FrameMonitor::instance();
+        frameMonitor.onControlBegin();
+
+        {
+            FrameMonitor::Scope recorderScope(FrameMonitor::Activity::Recorder);
+
+            // a recording driven by input playback ends with it
+            if (InputPlayer::instance().takeFinished() && recorder.isRecording())
+                recorder.stopRecording();
+
+            bool isInGame = scene && scene->mIsAlive;
+            if (isInGame) {
+                PlayerActorBase *playerBase = rs::getPlayerActor(scene);
+                recorder.recordFrame(scene, playerBase);
+            }
+        }
+
+        Orig(scene);
+
+        frameMonitor.onControlEnd();
+    }
+};
+
+// The control hook only runs while something needs it, the recorder or the frame monitor.
+void updateControlHook() {
+    bool isNeeded = recorder.isRecording() || FrameMonitor::instance().isEnabled();
+    if (isNeeded == ControlHook::IsEnabled())
+        return;
+
+    if (isNeeded)
+        ControlHook::Enable();
+    else
+        ControlHook::Disable();
+}
+
+HOOK_DEFINE_TRAMPOLINE(StageSceneInit) {
+    static void Callback(StageScene *scene, const al::SceneInitInfo &info) {
+        recorder.onStageSceneInit();
+        Orig(scene, info);
+    }
+};
+
 void drawDebugWindow() {
     HakoniwaSequence *gameSeq = (HakoniwaSequence *) GameSystemFunction::getGameSystem()->mCurSequence;
 
@@ -72,24 +126,35 @@ void drawDebugWindow() {
         if (ImGui::Button("START Recording")) {
             recorder.startRecording();
         }
+        // re-records a session from its input log, the new log replaces the one being played once written
+        if (ImGui::Button("PLAY Inputs") && InputPlayer::instance().start(InputPlayer::PLAYBACK_PATH)) {
+            recorder.startRecording();
+        }
+    }
+
+    InputRecorder &inputs = InputRecorder::instance();
+    if (recorder.isRecording()) {
+        ImGui::Text("Stages: %d", recorder.getSegmentCount());
+        InputPlayer &player = InputPlayer::instance();
+        if (player.isPlaying())
+            ImGui::Text("Playback: %u / %u (frame %u, %u stalls)", player.getSampleCount(),
+                        player.getTotalSampleCount(), player.getPoseFrame(), player.getStarveCount());
+        if (inputs.isRecording() || inputs.isOverflowed())
+            ImGui::Text("Inputs: %u (%.1f / %.1f KiB)%s", inputs.getSampleCount(), inputs.getSize() / 1024.f,
+                        inputs.getCapacity() / 1024.f, inputs.isOverflowed() ? " full" : "");
+    } else {
+        bool isInputRecordingEnabled = inputs.isEnabled();
+        if (ImGui::Checkbox("Record inputs", &isInputRecordingEnabled))
+            inputs.setEnabled(isInputRecordingEnabled);
     }
+    ImGui::Text("Arena: %.1f / %.1f MiB", recorder.getArenaUsedSize() / (1024.f * 1024.f),
+                recorder.getArenaSize() / (1024.f * 1024.f));
     ImGui::PopStyleColor(4);
 
     ImGui::End();
-}
-
-HOOK_DEFINE_TRAMPOLINE(ControlHook) {
-    static void Callback(StageScene *scene) {
-
-        bool isInGame = scene && scene->mIsAlive;
-        if (isInGame) {
-            PlayerActorBase *playerBase = rs::getPlayerActor(scene);
-            recorder.recordFrame(playerBase);
-        }
 
-        Orig(scene);
-    }
-};
+    updateControlHook();
+}
 
 HOOK_DEFINE_REPLACE(ReplaceSeadPrint) {
     static void Callback(const char *format, ...) {
@@ -107,7 +172,7 @@ HOOK_DEFINE_TRAMPOLINE(CreateFileDeviceMgr) {
 
         thisPtr->mMountedSd = nn::fs::MountSdCardForDebug("sd").isSuccess();
 
-        sead::NinSDFileDevice *sdFileDevice = new sead::NinSDFileDevice();
+        sead::NinSDFileDevice *sdFileDevice = new CachedSDFileDevice();
 
         thisPtr->mount(sdFileDevice);
     }
@@ -117,6 +182,8 @@ HOOK_DEFINE_TRAMPOLINE(RedirectFileDevice) {
     static sead::FileDevice *
     Callback(sead::FileDeviceMgr *thisPtr, sead::SafeString &path, sead::BufferedSafeString *pathNoDrive) {
 
+        FileAccessProfiler::Scope profile(FileAccessProfiler::Op::RedirectDevice, path);
+
         sead::FixedSafeString<32> driveName;
         sead::FileDevice *device;
 
@@ -148,6 +215,7 @@ HOOK_DEFINE_TRAMPOLINE(RedirectFileDevice) {
         if (pathNoDrive != nullptr)
             sead::Path::getPathExceptDrive(pathNoDrive, path);
 
+        profile.setDevice(device);
         return device;
     }
 };
@@ -158,6 +226,8 @@ HOOK_DEFINE_TRAMPOLINE(FileLoaderLoadArc) {
 
         // Logger::log("Path: %s\n", path.cstr());
 
+        FileAccessProfiler::Scope profile(FileAccessProfiler::Op::LoadArchive, path);
+
         sead::FileDevice *sdFileDevice = sead::FileDeviceMgr::instance()->findDevice("sd");
 
         if (sdFileDevice && sdFileDevice->isExistFile(path)) {
@@ -167,7 +237,13 @@ HOOK_DEFINE_TRAMPOLINE(FileLoaderLoadArc) {
             device = sdFileDevice;
         }
 
-        return Orig(thisPtr, path, ext, device);
+        profile.setDevice(device);
+
+        sead::ArchiveRes *archive = Orig(thisPtr, path, ext, device);
+        if (archive)
+            profile.setSize(archive->getRawSize());
+
+        return archive;
     }
 };
 
@@ -182,13 +258,23 @@ sead::FileDevice *tryFindNewDevice(sead::SafeString &path, sead::FileDevice *ori
 
 HOOK_DEFINE_TRAMPOLINE(FileLoaderIsExistFile) {
     static bool Callback(al::FileLoader *thisPtr, sead::SafeString &path, sead::FileDevice *device) {
-        return Orig(thisPtr, path, tryFindNewDevice(path, device));
+        FileAccessProfiler::Scope profile(FileAccessProfiler::Op::IsExistFile, path);
+
+        device = tryFindNewDevice(path, device);
+        profile.setDevice(device);
+
+        return Orig(thisPtr, path, device);
     }
 };
 
 HOOK_DEFINE_TRAMPOLINE(FileLoaderIsExistArchive) {
     static bool Callback(al::FileLoader *thisPtr, sead::SafeString &path, sead::FileDevice *device) {
-        return Orig(thisPtr, path, tryFindNewDevice(path, device));
+        FileAccessProfiler::Scope profile(FileAccessProfiler::Op::IsExistArchive, path);
+
+        device = tryFindNewDevice(path, device);
+        profile.setDevice(device);
+
+        return Orig(thisPtr, path, device);
     }
 };
 
@@ -221,10 +307,14 @@ HOOK_DEFINE_TRAMPOLINE(GameSystemInit) {
 
         Orig(thisPtr);
 
+        // the recorder's arena first, the cache sizes itself from what's left and keeps its reserve for the game
+        recorder.init(al::getStationedHeap());
+        ArchiveCache::instance().init(al::getStationedHeap());
+
     }
 };
 
-HOOK_DEFINE_TRAMPOLINE(DrawDebugMenu) {
+HOOK_DEFINE_PROFILED_TRAMPOLINE(DrawDebugMenu) {
     static void Callback(HakoniwaSequence *thisPtr) {
 
         Orig(thisPtr);
@@ -250,36 +340,62 @@ extern "C" void exl_main(void *x0, void *x1) {
 
     runCodePatches();
 
-    GameSystemInit::InstallAtOffset(0x535850);
+    loadSymbolCache();
 
-    // SD File Redirection
+    {
+        // all hooks below are written in one pass when the transaction goes out of scope
+        exl::hook::Transaction hookTransaction;
 
-    RedirectFileDevice::InstallAtOffset(0x76CFE0);
-    FileLoaderLoadArc::InstallAtOffset(0xA5EF64);
-    CreateFileDeviceMgr::InstallAtOffset(0x76C8D4);
-    FileLoaderIsExistFile::InstallAtSymbol(
-            "_ZNK2al10FileLoader11isExistFileERKN4sead14SafeStringBaseIcEEPNS1_10FileDeviceE");
-    FileLoaderIsExistArchive::InstallAtSymbol(
-            "_ZNK2al10FileLoader14isExistArchiveERKN4sead14SafeStringBaseIcEEPNS1_10FileDeviceE");
+        GameSystemInit::InstallAtOffset(0x535850);
 
-    // Sead Debugging Overriding
+        // SD File Redirection
 
-    ReplaceSeadPrint::InstallAtOffset(0xB59E28);
+        RedirectFileDevice::InstallAtOffset(0x76CFE0);
+        FileLoaderLoadArc::InstallAtOffset(0xA5EF64);
+        CreateFileDeviceMgr::InstallAtOffset(0x76C8D4);
+        FileLoaderIsExistFile::InstallAtSymbol(
+                "_ZNK2al10FileLoader11isExistFileERKN4sead14SafeStringBaseIcEEPNS1_10FileDeviceE");
+        FileLoaderIsExistArchive::InstallAtSymbol(
+                "_ZNK2al10FileLoader14isExistArchiveERKN4sead14SafeStringBaseIcEEPNS1_10FileDeviceE");
 
-    // Debug Text Writer Drawing
+        // Sead Debugging Overriding
 
-    DrawDebugMenu::InstallAtOffset(0x50F1D8);
+        ReplaceSeadPrint::InstallAtOffset(0xB59E28);
 
-    // General Hooks
+        // Debug Text Writer Drawing
 
-    ControlHook::InstallAtSymbol("_ZN10StageScene7controlEv");
+        DrawDebugMenu::InstallAtOffset(0x50F1D8);
 
-    // ImGui Hooks
-#if IMGUI_ENABLED
-    nvnImGui::InstallHooks();
+        // General Hooks
+
+        ControlHook::InstallAtSymbol("_ZN10StageScene7controlEv");
+        StageSceneInit::InstallAtSymbol("_ZN10StageScene4initERKN2al13SceneInitInfoE");
+
+        // Heap Instrumentation
 
-    nvnImGui::addDrawFunc(drawDebugWindow);
+        HeapMonitor::installHooks();
+
+        // ImGui Hooks
+#if IMGUI_ENABLED
+        nvnImGui::InstallHooks();
+
+        nvnImGui::addDrawFunc(drawDebugWindow);
+        nvnImGui::addDrawFunc(drawFileAccessProfilerWindow);
+        nvnImGui::addDrawFunc(drawHookProfilerWindow);
+        nvnImGui::addDrawFunc(drawModuleHeapWindow);
+        nvnImGui::addDrawFunc(drawHeapMonitorWindow);
+        nvnImGui::addDrawFunc(drawFrameMonitorWindow);
+        nvnImGui::addDrawFunc(drawCodePatchesWindow);
 #endif
+    }
+
+    saveSymbolCache();
+
+    updateControlHook();
+
+    exl::hook::TrampolineStats trampolineStats = exl::hook::GetTrampolineStats();
+    Logger::log("Hook trampolines: %lu/%lu used, %lu/%lu JIT blocks mapped\n", trampolineStats.m_UsedCount,
+                trampolineStats.m_Capacity, trampolineStats.m_MappedBlockCount, trampolineStats.m_BlockCount);
 
 }
 
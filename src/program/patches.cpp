@@ -1,34 +1,77 @@
 #include "patches.hpp"
 
+#include "imgui.h"
+#include "logger/Logger.hpp"
+
 namespace patch = exl::patch;
 namespace inst = exl::armv8::inst;
 namespace reg = exl::armv8::reg;
+using exl::armv8::decode::InstKind;
 
-void costumeRoomPatches() {
-    patch::CodePatcher p(0x262850);
-    p.WriteInst(inst::Movz(reg::W0, 0));
-    p.Seek(0x2609B4);
-    p.WriteInst(inst::Movz(reg::W0, 0));
+namespace {
+    using CodePatch = patch::TableEntry;
 
-    p.Seek(0x25FF74);
-    p.WriteInst(inst::Movz(reg::W0, 1));
-    p.Seek(0x25FF74);
-    p.WriteInst(inst::Movz(reg::W0, 0));
-}
+    // Expectations match the kind of instruction each patch replaces, not its exact word, which hasn't been checked
+    // against the 1.0 binary yet. A wrong one only keeps its own set from applying.
+    constexpr auto BL = exl::armv8::decode::PatternOf(InstKind::BL);
+
+    // All three replace the result of a call. C used to be written with 1 first, only the second write ever took effect.
+    constexpr CodePatch COSTUME_ROOM_PATCHES[] = {
+        {0x262850, {inst::Movz(reg::W0, 0)}, BL},
+        {0x2609B4, {inst::Movz(reg::W0, 0)}, BL},
+        {0x25FF74, {inst::Movz(reg::W0, 0)}, BL},
+    };
+
+    constexpr CodePatch SOCKET_INIT_PATCHES[] = {
+        {0x95C498, {inst::Nop()}, BL},
+    };
+
+    // CBZ, CBNZ, TBZ or TBNZ, the flag check that skips turning the debug layer on
+    constexpr exl::armv8::InstPattern REGISTER_TEST_BRANCH(0x34000000, 0x7C000000);
+
+    constexpr CodePatch DEBUG_NVN_PATCHES[] = {
+        {0x7312CC, {inst::Nop()}, REGISTER_TEST_BRANCH},
+    };
+
+    static_assert(!patch::HasOverlap(COSTUME_ROOM_PATCHES, SOCKET_INIT_PATCHES, DEBUG_NVN_PATCHES),
+                  "code patches overlap");
+
+    patch::PatchSet costumeRoomPatches("Costume room");
+    patch::PatchSet socketInitPatches("Stub socket init");
+    patch::PatchSet debugNvnPatches("NVN debug layer");
 
-void stubSocketInit() {
-    patch::CodePatcher p(0x95C498);
-    p.WriteInst(inst::Nop());
+    patch::PatchSet *const PATCH_SETS[] = {&costumeRoomPatches, &socketInitPatches, &debugNvnPatches};
 }
 
-void enableDebugNvn() {
-    patch::CodePatcher p(0x7312CC);
-    p.WriteInst(inst::Nop());
+void runCodePatches() {
+    costumeRoomPatches.AddTable(COSTUME_ROOM_PATCHES);
+    socketInitPatches.AddTable(SOCKET_INIT_PATCHES);
+    debugNvnPatches.AddTable(DEBUG_NVN_PATCHES);
+
+    // a set is only skipped when one of its own sites doesn't hold what it expects, the others still apply
+    patch::PatchSet::ApplyAll(PATCH_SETS);
+
+    for (const patch::PatchSet *set : PATCH_SETS) {
+        if (R_FAILED(set->GetResult()))
+            Logger::log("%s skipped: unexpected instruction 0x%08x at 0x%lx\n", set->GetName(), set->GetFailedInst(),
+                        set->GetFailedOffset());
+    }
 }
 
+void drawCodePatchesWindow() {
+    ImGui::Begin("Code Patches");
 
-void runCodePatches() {
-    costumeRoomPatches();
-    stubSocketInit();
-    enableDebugNvn();
-}
\ No newline at end of file
+    for (patch::PatchSet *set : PATCH_SETS) {
+        if (R_FAILED(set->GetResult())) {
+            ImGui::TextDisabled("%s: found 0x%08x at 0x%lx", set->GetName(), set->GetFailedInst(),
+                                set->GetFailedOffset());
+            continue;
+        }
+
+        bool applied = set->IsApplied();
+        if (ImGui::Checkbox(set->GetName(), &applied))
+            set->SetApplied(applied);
+    }
+
+    ImGui::End();
+}
@@ -2,4 +2,7 @@
 
 #include "lib.hpp"
 
-void runCodePatches(); 
\ No newline at end of file
+void runCodePatches(); 
+
+// Lets each group of code patches be reverted and re-applied at runtime.
+void drawCodePatchesWindow();
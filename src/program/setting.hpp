@@ -12,13 +12,21 @@
 #define EXL_SUPPORTS_REBOOTPAYLOAD
 */
 
+/* Compares every new rw alias against the memory it aliases. Reads the whole range, so only for chasing mapping bugs. */
+/*
+#define EXL_VERIFY_RW_PAGES
+*/
+
 namespace exl::setting {
-    /* How large the fake .bss heap will be. */
-    constexpr size_t HeapSize = 0x5000;
+    /* How large the .bss heap behind malloc and new will be. Size classes take a page each once used. */
+    constexpr size_t HeapSize = 0x40000;
 
-    /* How large the JIT area will be for hooks. */
+    /* How large each JIT block for hook trampolines will be. */
     constexpr size_t JitSize = 0x1000;
 
+    /* How many JIT blocks are reserved for hook trampolines. Blocks are only mapped once they are needed. */
+    constexpr size_t JitBlockCount = 8;
+
     /* How large the area will be inline hook pool. */
     constexpr size_t InlinePoolSize = 0x1000;
 
@@ -0,0 +1,218 @@
+#include "aarch64_interpreter.hpp"
+
+#include <cstring>
+
+namespace exl::test {
+
+    namespace {
+
+        constexpr uint32_t FlagN = 1u << 31;
+        constexpr uint32_t FlagZ = 1u << 30;
+        constexpr uint32_t FlagC = 1u << 29;
+        constexpr uint32_t FlagV = 1u << 28;
+
+        /* Sign extends the width bit field of value starting at bit lsb. */
+        int64_t SignedField(uint32_t value, uint32_t lsb, uint32_t width) {
+            uint64_t field = (value >> lsb) & ((1ull << width) - 1);
+            return static_cast<int64_t>(field << (64 - width)) >> (64 - width);
+        }
+
+        /* Register 31 is the zero register everywhere but the few operands that name SP. */
+        uint64_t ReadX(const CpuState& state, uint32_t reg) {
+            return reg == 31 ? 0 : state.m_X[reg];
+        }
+
+        void WriteX(CpuState& state, uint32_t reg, uint64_t value) {
+            if(reg != 31)
+                state.m_X[reg] = value;
+        }
+
+        uint64_t ReadXOrSp(const CpuState& state, uint32_t reg) {
+            return reg == 31 ? state.m_Sp : state.m_X[reg];
+        }
+
+        void WriteXOrSp(CpuState& state, uint32_t reg, uint64_t value) {
+            if(reg == 31)
+                state.m_Sp = value;
+            else
+                state.m_X[reg] = value;
+        }
+
+        /* AddWithCarry from the Arm ARM, returning the result truncated to the operand size. */
+        uint64_t AddWithCarry(bool is64, uint64_t x, uint64_t y, bool carry, uint32_t* nzcv) {
+            if(is64) {
+                unsigned __int128 unsignedSum = static_cast<unsigned __int128>(x) + y + carry;
+                __int128 signedSum = static_cast<__int128>(static_cast<int64_t>(x)) + static_cast<int64_t>(y) + carry;
+                uint64_t result = static_cast<uint64_t>(unsignedSum);
+
+                *nzcv = ((result >> 63) ? FlagN : 0) | (result == 0 ? FlagZ : 0) |
+                        (unsignedSum != result ? FlagC : 0) |
+                        (signedSum != static_cast<int64_t>(result) ? FlagV : 0);
+                return result;
+            }
+
+            uint64_t unsignedSum = static_cast<uint64_t>(static_cast<uint32_t>(x)) + static_cast<uint32_t>(y) + carry;
+            int64_t signedSum = static_cast<int64_t>(static_cast<int32_t>(x)) + static_cast<int32_t>(y) + carry;
+            uint32_t result = static_cast<uint32_t>(unsignedSum);
+
+            *nzcv = ((result >> 31) ? FlagN : 0) | (result == 0 ? FlagZ : 0) |
+                    (unsignedSum != result ? FlagC : 0) |
+                    (signedSum != static_cast<int32_t>(result) ? FlagV : 0);
+            return result;
+        }
+    }
+
+    bool ConditionHolds(uint32_t cond, uint32_t nzcv) {
+        const bool n = nzcv & FlagN, z = nzcv & FlagZ, c = nzcv & FlagC, v = nzcv & FlagV;
+
+        bool result;
+        switch((cond >> 1) & 7) {
+            case 0: result = z; break;
+            case 1: result = c; break;
+            case 2: result = n; break;
+            case 3: result = v; break;
+            case 4: result = c && !z; break;
+            case 5: result = n == v; break;
+            case 6: result = n == v && !z; break;
+            default: result = true; break;
+        }
+
+        /* AL and NV both always hold. */
+        if((cond & 1) && cond != 0xf)
+            result = !result;
+        return result;
+    }
+
+    bool Interpreter::IsReadable(uintptr_t address, size_t size) const {
+        for(const MemoryRange& range : m_Readable) {
+            if(address >= range.m_Start && address <= range.m_End && size <= range.m_End - address)
+                return true;
+        }
+        return false;
+    }
+
+    StopReason Interpreter::Run(CpuState& state, uintptr_t codeStart, uintptr_t codeEnd, size_t maxSteps) const {
+        for(size_t i = 0; i < maxSteps; i++) {
+            if(state.m_Pc < codeStart || state.m_Pc >= codeEnd)
+                return StopReason::Exited;
+
+            StopReason reason = Step(state);
+            if(reason != StopReason::Stepped)
+                return reason;
+        }
+
+        if(state.m_Pc < codeStart || state.m_Pc >= codeEnd)
+            return StopReason::Exited;
+        return StopReason::StepLimit;
+    }
+
+    StopReason Interpreter::Step(CpuState& state) const {
+        if(!IsReadable(state.m_Pc, sizeof(uint32_t)))
+            return StopReason::Undefined;
+
+        const uint64_t pc = state.m_Pc;
+        uint32_t ins;
+        std::memcpy(&ins, reinterpret_cast<const void*>(pc), sizeof(ins));
+
+        const uint32_t rd = ins & 0x1f;
+        const uint32_t rn = (ins >> 5) & 0x1f;
+        uint64_t next = pc + sizeof(uint32_t);
+
+        if(ins == 0xd503201fu) {
+            /* NOP */
+        } else if((ins & 0x7c000000u) == 0x14000000u) {
+            /* B, BL */
+            if(ins >> 31)
+                state.m_X[30] = next;
+            next = pc + SignedField(ins, 0, 26) * 4;
+        } else if((ins & 0xff000010u) == 0x54000000u) {
+            /* B.cond */
+            if(ConditionHolds(ins & 0xf, state.m_Nzcv))
+                next = pc + SignedField(ins, 5, 19) * 4;
+        } else if((ins & 0x7e000000u) == 0x34000000u) {
+            /* CBZ, CBNZ */
+            uint64_t value = ReadX(state, rd);
+            if(!(ins >> 31))
+                value = static_cast<uint32_t>(value);
+            if((value == 0) != static_cast<bool>(ins & (1u << 24)))
+                next = pc + SignedField(ins, 5, 19) * 4;
+        } else if((ins & 0x7e000000u) == 0x36000000u) {
+            /* TBZ, TBNZ */
+            uint32_t bit = ((ins >> 31) << 5) | ((ins >> 19) & 0x1f);
+            bool isSet = (ReadX(state, rd) >> bit) & 1;
+            if(isSet == static_cast<bool>(ins & (1u << 24)))
+                next = pc + SignedField(ins, 5, 14) * 4;
+        } else if((ins & 0xff9ffc1fu) == 0xd61f0000u) {
+            /* BR, BLR, RET */
+            uint64_t target = ReadX(state, rn);
+            if(ins & (1u << 21))
+                state.m_X[30] = next;
+            next = target;
+        } else if((ins & 0x3b000000u) == 0x18000000u) {
+            /* LDR (literal), LDRSW (literal), PRFM (literal) */
+            const uint32_t opc = ins >> 30;
+            const bool isVector = ins & (1u << 26);
+            const uintptr_t address = pc + SignedField(ins, 5, 19) * 4;
+
+            if(isVector) {
+                if(opc == 3)
+                    return StopReason::Undefined;
+
+                size_t size = 4u << opc;
+                if(!IsReadable(address, size))
+                    return StopReason::BadLoad;
+
+                /* Scalar loads clear the rest of the vector register. */
+                state.m_V[rd] = {};
+                std::memcpy(state.m_V[rd].data(), reinterpret_cast<const void*>(address), size);
+            } else if(opc != 3) {
+                size_t size = opc == 1 ? 8 : 4;
+                if(!IsReadable(address, size))
+                    return StopReason::BadLoad;
+
+                uint64_t value = 0;
+                std::memcpy(&value, reinterpret_cast<const void*>(address), size);
+                if(opc == 2)
+                    value = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(value)));
+                WriteX(state, rd, value);
+            }
+        } else if((ins & 0x1f000000u) == 0x10000000u) {
+            /* ADR, ADRP */
+            int64_t imm = (SignedField(ins, 5, 19) << 2) | ((ins >> 29) & 3);
+            if(ins >> 31)
+                WriteX(state, rd, (pc & ~0xfffull) + (imm << 12));
+            else
+                WriteX(state, rd, pc + imm);
+        } else if((ins & 0x7f800000u) == 0x52800000u) {
+            /* MOVZ */
+            const bool is64 = ins >> 31;
+            const uint32_t hw = (ins >> 21) & 3;
+            if(!is64 && hw > 1)
+                return StopReason::Undefined;
+
+            WriteX(state, rd, static_cast<uint64_t>((ins >> 5) & 0xffff) << (hw * 16));
+        } else if((ins & 0x1f800000u) == 0x11000000u) {
+            /* ADD, ADDS, SUB, SUBS (immediate) */
+            const bool is64 = ins >> 31;
+            const bool isSub = ins & (1u << 30);
+            const bool setFlags = ins & (1u << 29);
+            uint64_t imm = (ins >> 10) & 0xfff;
+            if(ins & (1u << 22))
+                imm <<= 12;
+
+            uint32_t nzcv;
+            uint64_t result = AddWithCarry(is64, ReadXOrSp(state, rn), isSub ? ~imm : imm, isSub, &nzcv);
+            if(setFlags) {
+                state.m_Nzcv = nzcv;
+                WriteX(state, rd, result);
+            } else {
+                WriteXOrSp(state, rd, result);
+            }
+        } else {
+            return StopReason::Undefined;
+        }
+
+        state.m_Pc = next;
+        return StopReason::Stepped;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace exl::test {
+
+    /* Registers as the interpreter sees them. Addresses are host addresses, so code and literals are read in place. */
+    struct CpuState {
+        std::array<uint64_t, 31> m_X;
+        uint64_t m_Sp;
+        /* Q registers as low and high halves. */
+        std::array<std::array<uint64_t, 2>, 32> m_V;
+        /* N, Z, C and V in bits 31 to 28, like the NZCV system register. */
+        uint32_t m_Nzcv;
+        uint64_t m_Pc;
+    };
+
+    struct MemoryRange {
+        uintptr_t m_Start;
+        uintptr_t m_End;
+    };
+
+    enum class StopReason {
+        /* Only from Step, the instruction ran. */
+        Stepped,
+        /* The PC left the code range, m_Pc is where it went. */
+        Exited,
+        StepLimit,
+        Undefined,
+        BadLoad,
+    };
+
+    /* Runs the subset of AArch64 that hook trampolines are made of: B, BL, B.cond, CBZ/CBNZ, TBZ/TBNZ, BR, BLR, */
+    /* RET, literal loads and PRFM, ADR/ADRP, MOVZ, ADD/SUB (immediate) and NOP. Anything else stops with Undefined. */
+    class Interpreter {
+        public:
+            /* Literal loads outside of readable stop with BadLoad instead of touching host memory. */
+            explicit Interpreter(std::span<const MemoryRange> readable) : m_Readable(readable) {}
+
+            /* Steps until the PC leaves [codeStart, codeEnd) or maxSteps instructions ran. */
+            StopReason Run(CpuState& state, uintptr_t codeStart, uintptr_t codeEnd, size_t maxSteps) const;
+
+            /* Runs the instruction at state.m_Pc. */
+            StopReason Step(CpuState& state) const;
+
+        private:
+            bool IsReadable(uintptr_t address, size_t size) const;
+
+            std::span<const MemoryRange> m_Readable;
+    };
+
+    /* Whether cond (the low four bits of B.cond) holds for nzcv. */
+    bool ConditionHolds(uint32_t cond, uint32_t nzcv);
+}
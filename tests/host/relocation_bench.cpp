@@ -0,0 +1,105 @@
+/* Times __fix_instructions over a large batch of hook sites, the way a transaction installs them: near hooks */
+/* relocate one instruction, far hooks four or five, each into its own trampoline slot. */
+/* */
+/* usage: relocation_bench [hooks] [rounds] [seed] */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "fix_instructions.hpp"
+#include "relocation_corpus.hpp"
+
+using namespace exl::test;
+using exl::hook::nx64::MaxInstructions;
+
+namespace {
+
+    constexpr size_t TrampolineSize = MaxInstructions * 10;
+    constexpr size_t TrampolineBytes = TrampolineSize * sizeof(uint32_t);
+    /* Room for one block per site, 32 bytes apart. */
+    constexpr size_t SiteStride = 0x20;
+
+    constexpr size_t WindowOffset = 0;
+    constexpr size_t WindowSize = 16ull << 20;
+    constexpr size_t BlockZoneOffset = WindowOffset + (1ull << 20);
+    constexpr size_t BlockZoneSize = WindowSize - (2ull << 20);
+    /* The pool sits past literal and conditional branch reach of most sites, like the JIT does from .text. */
+    constexpr size_t PoolOffset = WindowOffset + WindowSize + (16ull << 20);
+
+    struct Site {
+        uint32_t* m_Block;
+        int m_Count;
+    };
+}
+
+int main(int argc, char** argv) {
+    const size_t hookCount = std::min<size_t>(argc > 1 ? strtoull(argv[1], nullptr, 0) : 65536, BlockZoneSize / SiteStride);
+    const int rounds = std::max(argc > 2 ? atoi(argv[2]) : 20, 1);
+    const uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 0) : 0x6578'6c62'656e'6368ull;
+
+    DualMappedArena arena(PoolOffset + hookCount * TrampolineBytes);
+    uint8_t* const base = arena.GetRx();
+
+    const MemoryRange window = {reinterpret_cast<uintptr_t>(base + WindowOffset), reinterpret_cast<uintptr_t>(base + WindowOffset + WindowSize)};
+    uint32_t* const poolRx = reinterpret_cast<uint32_t*>(base + PoolOffset);
+    uint32_t* const poolRw = arena.ToRw(poolRx);
+    const MemoryRange pool = {reinterpret_cast<uintptr_t>(poolRx), reinterpret_cast<uintptr_t>(poolRx) + hookCount * TrampolineBytes};
+
+    CorpusGenerator generator(seed, window);
+    auto& rng = generator.GetRng();
+    for(size_t i = 0; i < WindowSize; i += sizeof(uint64_t)) {
+        uint64_t value = rng();
+        std::memcpy(base + WindowOffset + i, &value, sizeof(value));
+    }
+
+    std::vector<Site> sites(hookCount);
+    size_t instructionCount = 0;
+    for(size_t i = 0; i < hookCount; i++) {
+        uint32_t* block = reinterpret_cast<uint32_t*>(base + BlockZoneOffset + i * SiteStride);
+        int count = rng() % 2 == 0 ? 1 : ((reinterpret_cast<uintptr_t>(block + 2) & 7) != 0 ? 5 : 4);
+
+        generator.Generate(block, count, pool);
+        sites[i] = {block, count};
+        instructionCount += count;
+    }
+
+    std::vector<double> roundSeconds;
+    for(int round = 0; round < rounds; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < hookCount; i++) {
+            const Site& site = sites[i];
+            if(!exl::hook::nx64::__fix_instructions(site.m_Block, site.m_Block, site.m_Count, poolRw + i * TrampolineSize, poolRx + i * TrampolineSize)) {
+                fprintf(stderr, "relocation failed for site %zu\n", i);
+                return EXIT_FAILURE;
+            }
+        }
+        roundSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    /* How much the trampolines grew over the instructions they replace. */
+    size_t outputWords = 0;
+    for(size_t i = 0; i < hookCount; i++) {
+        const uint32_t* trampoline = poolRx + i * TrampolineSize;
+        size_t used = TrampolineSize;
+        while(used > 0 && trampoline[used - 1] == 0)
+            used--;
+        outputWords += used;
+    }
+
+    std::sort(roundSeconds.begin(), roundSeconds.end());
+    const double best = roundSeconds.front();
+    const double median = roundSeconds[roundSeconds.size() / 2];
+
+    printf("%zu hooks, %zu instructions, %d rounds (seed 0x%" PRIx64 ")\n", hookCount, instructionCount, rounds, seed);
+    printf("best   %8.2f ms  %7.1f ns/hook  %7.2f M instructions/s\n", best * 1e3, best * 1e9 / hookCount,
+           instructionCount / best / 1e6);
+    printf("median %8.2f ms  %7.1f ns/hook  %7.2f M instructions/s\n", median * 1e3, median * 1e9 / hookCount,
+           instructionCount / median / 1e6);
+    printf("%.2f trampoline words per relocated instruction\n", static_cast<double>(outputWords) / instructionCount);
+    return EXIT_SUCCESS;
+}
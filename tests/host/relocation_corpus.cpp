@@ -0,0 +1,187 @@
+#include "relocation_corpus.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace exl::test {
+
+    namespace {
+
+        constexpr int64_t BranchRange = 1ll << 27;
+        constexpr int64_t CondBranchRange = 1ll << 20;
+        constexpr int64_t TestBranchRange = 1ll << 15;
+        constexpr int64_t LiteralRange = 1ll << 20;
+        /* Q literals are the widest load. */
+        constexpr uint64_t MaxLiteralSize = 16;
+
+        bool Overlaps(uintptr_t start, uintptr_t end, MemoryRange range) {
+            return start < range.m_End && range.m_Start < end;
+        }
+
+        uint32_t Field(int64_t value, uint32_t width, uint32_t lsb) {
+            return (static_cast<uint64_t>(value) & ((1ull << width) - 1)) << lsb;
+        }
+    }
+
+    DualMappedArena::DualMappedArena(size_t size) : m_Size(size) {
+        int fd = memfd_create("exl-relocation-arena", 0);
+        if(fd < 0 || ftruncate(fd, size) != 0) {
+            perror("memfd");
+            abort();
+        }
+
+        /* Both views stay sparse, only what the tests touch gets backed. */
+        void* rx = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+        void* rw = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+        close(fd);
+        if(rx == MAP_FAILED || rw == MAP_FAILED) {
+            perror("mmap");
+            abort();
+        }
+
+        m_Rx = static_cast<uint8_t*>(rx);
+        m_Rw = static_cast<uint8_t*>(rw);
+    }
+
+    DualMappedArena::~DualMappedArena() {
+        munmap(m_Rx, m_Size);
+        munmap(m_Rw, m_Size);
+    }
+
+    void CorpusGenerator::Generate(uint32_t* block, int count, MemoryRange avoid) {
+        const uintptr_t blockStart = reinterpret_cast<uintptr_t>(block);
+        const uintptr_t blockEnd = blockStart + count * sizeof(uint32_t);
+
+        for(int i = 0; i < count; i++)
+            block[i] = MakeInstruction(blockStart + i * sizeof(uint32_t), blockStart, blockEnd, avoid);
+    }
+
+    CpuState CorpusGenerator::MakeState(uint64_t pc) {
+        CpuState state = {};
+        for(uint64_t& x : state.m_X)
+            x = Next(4) == 0 ? 0 : m_Rng();
+        state.m_X[30] = InitialLinkRegister;
+        state.m_Sp = m_Rng() & ~0xfull;
+        for(auto& v : state.m_V)
+            v = {m_Rng(), m_Rng()};
+        state.m_Nzcv = static_cast<uint32_t>(Next(16)) << 28;
+        state.m_Pc = pc;
+        return state;
+    }
+
+    uint32_t CorpusGenerator::RandomRegister() {
+        /* X16 and X17 are the relocator's scratch registers and LR differs by design, so blocks never read them. */
+        return static_cast<uint32_t>(Next(16));
+    }
+
+    int64_t CorpusGenerator::RandomBranchOffset(uintptr_t pc, uintptr_t blockStart, uintptr_t blockEnd, MemoryRange avoid, int64_t range) {
+        /* Branches within the block, including to the instruction right after it, take the relocator's */
+        /* fix up path instead of the absolute one. */
+        if(Next(10) < 3) {
+            uint64_t index = Next((blockEnd - blockStart) / sizeof(uint32_t) + 1);
+            return static_cast<int64_t>(blockStart + index * sizeof(uint32_t) - pc);
+        }
+
+        while(true) {
+            /* Half of the targets are close by, the rest anywhere the encoding reaches. */
+            int64_t reach = Next(2) == 0 ? std::min<int64_t>(range, 0x10000) : range;
+            int64_t offset = (static_cast<int64_t>(Next(2 * reach / 4)) - reach / 4) * 4;
+            uintptr_t target = pc + offset;
+
+            if(!Overlaps(target, target + 1, {blockStart, blockEnd}) && !Overlaps(target, target + 1, avoid))
+                return offset;
+        }
+    }
+
+    int64_t CorpusGenerator::RandomLiteralOffset(uintptr_t pc, MemoryRange avoid) {
+        while(true) {
+            int64_t offset = (static_cast<int64_t>(Next(2 * LiteralRange / 4)) - LiteralRange / 4) * 4;
+            uintptr_t target = pc + offset;
+
+            if(target >= m_Literals.m_Start && target + MaxLiteralSize <= m_Literals.m_End &&
+               !Overlaps(target, target + MaxLiteralSize, avoid))
+                return offset;
+        }
+    }
+
+    uint32_t CorpusGenerator::MakeInstruction(uintptr_t pc, uintptr_t blockStart, uintptr_t blockEnd, MemoryRange avoid) {
+        const uint64_t kind = Next(100);
+
+        if(kind < 5) {
+            /* MOVZ */
+            uint32_t sf = Next(2);
+            return (sf << 31) | 0x52800000u | Field(Next(sf ? 4 : 2), 2, 21) | Field(Next(0x10000), 16, 5) |
+                   RandomRegister();
+        }
+        if(kind < 20) {
+            /* ADD, ADDS, SUB, SUBS (immediate) */
+            return Field(Next(8), 3, 29) | 0x11000000u | Field(Next(2), 1, 22) | Field(Next(0x1000), 12, 10) |
+                   (RandomRegister() << 5) | RandomRegister();
+        }
+        if(kind < 40) {
+            /* B, BL */
+            uint32_t op = kind < 30 ? 0x14000000u : 0x94000000u;
+            return op | Field(RandomBranchOffset(pc, blockStart, blockEnd, avoid, BranchRange) / 4, 26, 0);
+        }
+        if(kind < 50) {
+            /* B.cond */
+            return 0x54000000u | Field(RandomBranchOffset(pc, blockStart, blockEnd, avoid, CondBranchRange) / 4, 19, 5) |
+                   static_cast<uint32_t>(Next(16));
+        }
+        if(kind < 60) {
+            /* CBZ, CBNZ */
+            return Field(Next(2), 1, 31) | 0x34000000u | Field(Next(2), 1, 24) |
+                   Field(RandomBranchOffset(pc, blockStart, blockEnd, avoid, CondBranchRange) / 4, 19, 5) |
+                   RandomRegister();
+        }
+        if(kind < 68) {
+            /* TBZ, TBNZ */
+            uint32_t bit = Next(64);
+            return Field(bit >> 5, 1, 31) | 0x36000000u | Field(Next(2), 1, 24) | Field(bit, 5, 19) |
+                   Field(RandomBranchOffset(pc, blockStart, blockEnd, avoid, TestBranchRange) / 4, 14, 5) |
+                   RandomRegister();
+        }
+        if(kind < 88) {
+            /* LDR Wt/Xt, LDRSW, LDR St/Dt/Qt and PRFM (literal) */
+            uint32_t opc, vector;
+            if(kind < 80) {
+                opc = Next(3);
+                vector = 0;
+            } else if(kind < 85) {
+                opc = Next(3);
+                vector = 1;
+            } else {
+                opc = 3;
+                vector = 0;
+            }
+
+            /* Some literals come from the block itself, which the relocator has to copy out. */
+            int64_t offset;
+            uintptr_t blockTarget = blockStart + Next((blockEnd - blockStart) / sizeof(uint32_t)) * sizeof(uint32_t);
+            if(Next(8) == 0 && !Overlaps(blockTarget, blockTarget + MaxLiteralSize, avoid))
+                offset = static_cast<int64_t>(blockTarget - pc);
+            else
+                offset = RandomLiteralOffset(pc, avoid);
+
+            return (opc << 30) | 0x18000000u | (vector << 26) | Field(offset / 4, 19, 5) |
+                   (opc == 3 ? static_cast<uint32_t>(Next(32)) : RandomRegister());
+        }
+        if(kind < 94) {
+            /* ADR */
+            while(true) {
+                int64_t offset = static_cast<int64_t>(Next(2 * LiteralRange)) - LiteralRange;
+                if(Overlaps(pc + offset, pc + offset + 1, {blockStart, blockEnd}))
+                    continue;
+
+                return 0x10000000u | Field(offset, 2, 29) | Field(offset >> 2, 19, 5) | RandomRegister();
+            }
+        }
+
+        /* ADRP, mostly to the pages around the block so the in-block page gets hit too. */
+        int64_t pages = Next(2) == 0 ? static_cast<int64_t>(Next(5)) - 2 : static_cast<int64_t>(Next(1 << 21)) - (1 << 20);
+        return 0x90000000u | Field(pages, 2, 29) | Field(pages >> 2, 19, 5) | RandomRegister();
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "aarch64_interpreter.hpp"
+
+namespace exl::test {
+
+    /* One memfd mapped twice, so trampolines get separate rx and rw addresses like they do in the hook JIT. */
+    class DualMappedArena {
+        public:
+            explicit DualMappedArena(size_t size);
+            ~DualMappedArena();
+
+            DualMappedArena(const DualMappedArena&) = delete;
+            DualMappedArena& operator=(const DualMappedArena&) = delete;
+
+            uint8_t* GetRx() const { return m_Rx; }
+            size_t GetSize() const { return m_Size; }
+
+            template<typename T>
+            T* ToRw(T* rx) const {
+                return reinterpret_cast<T*>(m_Rw + (reinterpret_cast<uint8_t*>(rx) - m_Rx));
+            }
+
+        private:
+            uint8_t* m_Rx;
+            uint8_t* m_Rw;
+            size_t m_Size;
+    };
+
+    /* Random instruction blocks for the relocator, weighted towards the PC-relative encodings it has to rewrite. */
+    class CorpusGenerator {
+        public:
+            /* Literal loads only ever point into literals, which should be readable and hold random data. */
+            CorpusGenerator(uint64_t seed, MemoryRange literals) : m_Rng(seed), m_Literals(literals) {}
+
+            /* Writes count instructions to block. Nothing points into avoid, and ADR never points into the block */
+            /* itself since the relocator deliberately moves those to the trampoline. */
+            void Generate(uint32_t* block, int count, MemoryRange avoid);
+
+            /* Random registers and flags for running a block. LR is kept away from code so calls can be told apart. */
+            CpuState MakeState(uint64_t pc);
+
+            std::mt19937_64& GetRng() { return m_Rng; }
+
+        private:
+            uint32_t MakeInstruction(uintptr_t pc, uintptr_t blockStart, uintptr_t blockEnd, MemoryRange avoid);
+            uint32_t RandomRegister();
+            int64_t RandomBranchOffset(uintptr_t pc, uintptr_t blockStart, uintptr_t blockEnd, MemoryRange avoid, int64_t range);
+            int64_t RandomLiteralOffset(uintptr_t pc, MemoryRange avoid);
+
+            uint64_t Next(uint64_t bound) { return m_Rng() % bound; }
+
+            std::mt19937_64 m_Rng;
+            MemoryRange m_Literals;
+    };
+
+    /* LR value the generated states start with, nowhere near the arena. */
+    constexpr uint64_t InitialLinkRegister = 0x4c52'4c52'0000'0000ull;
+}
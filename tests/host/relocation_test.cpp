@@ -0,0 +1,266 @@
+/* Relocates random instruction blocks with __fix_instructions and runs the original and the trampoline side by */
+/* side in the interpreter. Both have to make the same calls and leave to the same place with the same registers. */
+/* */
+/* usage: relocation_test [iterations] [seed] */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "aarch64_interpreter.hpp"
+#include "fix_instructions.hpp"
+#include "relocation_corpus.hpp"
+
+using namespace exl::test;
+using exl::hook::nx64::MaxInstructions;
+
+namespace {
+
+    /* Same as the hook JIT's slots. */
+    constexpr size_t TrampolineSize = MaxInstructions * 10;
+    constexpr size_t TrampolineBytes = TrampolineSize * sizeof(uint32_t);
+    /* Checked after relocating, anything written here overflowed the slot. */
+    constexpr size_t GuardBytes = 64;
+
+    constexpr size_t ArenaSize = 640ull << 20;
+    /* Blocks and every literal they load live here, filled with random data. */
+    constexpr size_t WindowOffset = 160ull << 20;
+    constexpr size_t WindowSize = 4ull << 20;
+    constexpr size_t BlockZoneOffset = WindowOffset + (1ull << 20) + 0x10000;
+    constexpr size_t BlockZoneSize = WindowSize - (2ull << 20) - 0x20000;
+    /* Past the reach of literal loads and conditional branches, but not of B/BL. */
+    constexpr size_t MidAreaOffset = WindowOffset + (16ull << 20);
+    /* Out of B/BL range from everything in the window. */
+    constexpr size_t FarAreaOffset = WindowOffset + (400ull << 20);
+    constexpr size_t AreaSize = 1ull << 20;
+
+    constexpr size_t MaxSteps = 512;
+    /* Relocated instructions can take up to six, a loop the original leaves has to be left by the trampoline too. */
+    constexpr size_t MaxRelocatedSteps = MaxSteps * 8;
+    constexpr int MaxExits = 16;
+    constexpr int StatesPerBlock = 4;
+    constexpr int MaxReportedFailures = 8;
+    /* What the model callee leaves in LR, so a later exit isn't taken for another call. */
+    constexpr uint64_t CalleeLinkRegister = 0x4341'4c4c'0000'0000ull;
+
+    enum class Placement {
+        Near,
+        Mid,
+        Far,
+        Count,
+    };
+
+    const char* GetPlacementName(Placement placement) {
+        switch(placement) {
+            case Placement::Near: return "near";
+            case Placement::Mid: return "mid";
+            default: return "far";
+        }
+    }
+
+    struct Exit {
+        /* Leaving with LR pointing back into the code is a call, the model callee returns straight away. */
+        bool m_IsCall;
+        CpuState m_State;
+    };
+
+    struct Trace {
+        StopReason m_Reason;
+        int m_ExitCount;
+        Exit m_Exits[MaxExits];
+    };
+
+    void Execute(const Interpreter& interpreter, CpuState state, uintptr_t codeStart, uintptr_t codeEnd, size_t maxSteps, Trace* trace) {
+        trace->m_ExitCount = 0;
+
+        while(true) {
+            trace->m_Reason = interpreter.Run(state, codeStart, codeEnd, maxSteps);
+            if(trace->m_Reason != StopReason::Exited || trace->m_ExitCount == MaxExits)
+                return;
+
+            /* A BL at the end of the block returns to the instruction right after it. */
+            const uint64_t lr = state.m_X[30];
+            const bool isCall = lr >= codeStart && lr <= codeEnd;
+            trace->m_Exits[trace->m_ExitCount++] = {isCall, state};
+            if(!isCall)
+                return;
+
+            state.m_Pc = lr;
+            state.m_X[30] = CalleeLinkRegister;
+        }
+    }
+
+    /* Returns a description of the first difference, or nullptr if the traces agree. */
+    const char* Compare(const Trace& original, const Trace& relocated, char* buffer, size_t bufferSize) {
+        if(original.m_Reason != relocated.m_Reason) {
+            snprintf(buffer, bufferSize, "stopped with %d instead of %d", static_cast<int>(relocated.m_Reason),
+                     static_cast<int>(original.m_Reason));
+            return buffer;
+        }
+
+        if(original.m_ExitCount != relocated.m_ExitCount) {
+            snprintf(buffer, bufferSize, "%d exits instead of %d", relocated.m_ExitCount, original.m_ExitCount);
+            return buffer;
+        }
+
+        for(int i = 0; i < original.m_ExitCount; i++) {
+            const Exit& expected = original.m_Exits[i];
+            const Exit& actual = relocated.m_Exits[i];
+
+            if(expected.m_IsCall != actual.m_IsCall || expected.m_State.m_Pc != actual.m_State.m_Pc) {
+                snprintf(buffer, bufferSize, "exit %d: %s to 0x%" PRIx64 " instead of %s to 0x%" PRIx64, i,
+                         actual.m_IsCall ? "call" : "branch", actual.m_State.m_Pc,
+                         expected.m_IsCall ? "call" : "branch", expected.m_State.m_Pc);
+                return buffer;
+            }
+
+            for(int reg = 0; reg < 31; reg++) {
+                /* X17 is the relocator's scratch register, and calls return into different code. */
+                if(reg == 17 || (reg == 30 && expected.m_IsCall))
+                    continue;
+
+                if(expected.m_State.m_X[reg] != actual.m_State.m_X[reg]) {
+                    snprintf(buffer, bufferSize, "exit %d: X%d is 0x%" PRIx64 " instead of 0x%" PRIx64, i, reg,
+                             actual.m_State.m_X[reg], expected.m_State.m_X[reg]);
+                    return buffer;
+                }
+            }
+
+            if(expected.m_State.m_V != actual.m_State.m_V) {
+                snprintf(buffer, bufferSize, "exit %d: vector registers differ", i);
+                return buffer;
+            }
+
+            if(expected.m_State.m_Nzcv != actual.m_State.m_Nzcv || expected.m_State.m_Sp != actual.m_State.m_Sp) {
+                snprintf(buffer, bufferSize, "exit %d: flags or SP differ", i);
+                return buffer;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void DumpWords(const char* name, const uint32_t* words, size_t count) {
+        printf("  %s:", name);
+        for(size_t i = 0; i < count; i++)
+            printf(" %08x", words[i]);
+        printf("\n");
+    }
+
+    /* Words up to the last non zero one, the rest of the slot was cleared before relocating. */
+    size_t GetUsedWords(const uint32_t* trampoline) {
+        size_t count = TrampolineSize;
+        while(count > 0 && trampoline[count - 1] == 0)
+            count--;
+        return count;
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint64_t iterations = argc > 1 ? strtoull(argv[1], nullptr, 0) : 100000;
+    const uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 0) : 0x6578'6c68'6f6f'6b00ull;
+
+    DualMappedArena arena(ArenaSize);
+    uint8_t* const base = arena.GetRx();
+
+    const MemoryRange window = {reinterpret_cast<uintptr_t>(base + WindowOffset), reinterpret_cast<uintptr_t>(base + WindowOffset + WindowSize)};
+    const MemoryRange readable[] = {
+        window,
+        {reinterpret_cast<uintptr_t>(base + MidAreaOffset), reinterpret_cast<uintptr_t>(base + MidAreaOffset + AreaSize)},
+        {reinterpret_cast<uintptr_t>(base + FarAreaOffset), reinterpret_cast<uintptr_t>(base + FarAreaOffset + AreaSize)},
+    };
+    const Interpreter interpreter(readable);
+
+    CorpusGenerator generator(seed, window);
+    auto& rng = generator.GetRng();
+    for(size_t i = 0; i < WindowSize; i += sizeof(uint64_t)) {
+        uint64_t value = rng();
+        std::memcpy(base + WindowOffset + i, &value, sizeof(value));
+    }
+
+    uint64_t failures = 0;
+    uint64_t loops = 0;
+    Trace original, relocated;
+    char message[0x100];
+
+    for(uint64_t iteration = 0; iteration < iterations; iteration++) {
+        const Placement placement = static_cast<Placement>(iteration % static_cast<uint64_t>(Placement::Count));
+        const int count = 1 + static_cast<int>(rng() % MaxInstructions);
+
+        /* Some blocks start a page so ADRP can point at the block's own page. */
+        uintptr_t blockOffset = BlockZoneOffset + (rng() % (BlockZoneSize / 4)) * 4;
+        if(rng() % 8 == 0)
+            blockOffset &= ~0xfffull;
+        uint32_t* const block = reinterpret_cast<uint32_t*>(base + blockOffset);
+        const uintptr_t blockStart = reinterpret_cast<uintptr_t>(block);
+        const uintptr_t blockEnd = blockStart + count * sizeof(uint32_t);
+
+        /* Trampoline slots are 8 byte aligned in the JIT, 4 byte aligned ones are covered too. */
+        uintptr_t trampolineOffset;
+        switch(placement) {
+            case Placement::Near:
+                do {
+                    trampolineOffset = blockOffset + (rng() % 0x40000) * 4 - 0x80000;
+                } while(trampolineOffset < blockOffset + count * sizeof(uint32_t) + MaxInstructions * sizeof(uint32_t) &&
+                        trampolineOffset + TrampolineBytes + GuardBytes > blockOffset);
+                break;
+            case Placement::Mid:
+                trampolineOffset = MidAreaOffset + (rng() % ((AreaSize - TrampolineBytes - GuardBytes) / 4)) * 4;
+                break;
+            default:
+                trampolineOffset = FarAreaOffset + (rng() % ((AreaSize - TrampolineBytes - GuardBytes) / 4)) * 4;
+                break;
+        }
+        uint32_t* const trampolineRx = reinterpret_cast<uint32_t*>(base + trampolineOffset);
+        uint32_t* const trampolineRw = arena.ToRw(trampolineRx);
+        const uintptr_t trampolineStart = reinterpret_cast<uintptr_t>(trampolineRx);
+        const uintptr_t trampolineEnd = trampolineStart + TrampolineBytes;
+
+        std::memset(trampolineRw, 0, TrampolineBytes + GuardBytes);
+        generator.Generate(block, count, {trampolineStart, trampolineEnd + GuardBytes});
+
+        bool isOk = exl::hook::nx64::__fix_instructions(block, block, count, trampolineRw, trampolineRx);
+        const uint8_t* guard = reinterpret_cast<const uint8_t*>(trampolineRx) + TrampolineBytes;
+        bool isGuardIntact = true;
+        for(size_t i = 0; i < GuardBytes; i++)
+            isGuardIntact &= guard[i] == 0;
+
+        const char* failure = nullptr;
+        if(!isOk)
+            failure = "relocation failed";
+        else if(!isGuardIntact)
+            failure = "trampoline overflowed its slot";
+
+        for(int i = 0; i < StatesPerBlock && failure == nullptr; i++) {
+            CpuState state = generator.MakeState(blockStart);
+            Execute(interpreter, state, blockStart, blockEnd, MaxSteps, &original);
+
+            /* Nothing to compare when the original never leaves. */
+            if(original.m_Reason == StopReason::StepLimit) {
+                loops++;
+                continue;
+            }
+
+            state.m_Pc = trampolineStart;
+            Execute(interpreter, state, trampolineStart, trampolineEnd, MaxRelocatedSteps, &relocated);
+
+            failure = Compare(original, relocated, message, sizeof(message));
+        }
+
+        if(failure == nullptr)
+            continue;
+
+        if(failures++ < MaxReportedFailures) {
+            printf("iteration %" PRIu64 " (%s, %d instructions, block at page offset 0x%" PRIxPTR ", trampoline %+" PRId64 "): %s\n",
+                   iteration, GetPlacementName(placement), count, blockStart & 0xfff,
+                   static_cast<int64_t>(trampolineStart - blockStart), failure);
+            DumpWords("original", block, count);
+            DumpWords("trampoline", trampolineRx, GetUsedWords(trampolineRx));
+        }
+    }
+
+    printf("%" PRIu64 " blocks, %" PRIu64 " failed, %" PRIu64 " runs never left the original (seed 0x%" PRIx64 ")\n",
+           iterations, failures, loops, seed);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}